@@ -13,8 +13,19 @@ defmodule ExLibSRTBundlexProject do
         sources: [
           "srt_nif.cpp",
           "server/server.cpp",
+          "server/admission_rules.cpp",
+          "server/ts_inspector.cpp",
           "client/client.cpp",
-          "common/srt_socket_stats.cpp"
+          "client/send_ring.cpp",
+          "common/srt_socket_stats.cpp",
+          "common/payload_slab.cpp",
+          "common/payload_pins.cpp",
+          "common/stats_sampler.cpp",
+          "common/latency_histograms.cpp",
+          "common/native_metrics.cpp",
+          "common/command_mailbox.cpp",
+          "common/transfer_options.cpp",
+          "common/socket_options.cpp"
         ],
         deps: [unifex: :unifex],
         os_deps: [
@@ -32,6 +43,46 @@ defmodule ExLibSRTBundlexProject do
           "-std=c++17"
         ]
       ]
-    ]
+    ] ++ bench_natives()
+  end
+
+  # the benchmark runs the native server and client without the BEAM, so it's built only on demand
+  defp bench_natives() do
+    if System.get_env("EX_LIBSRT_BENCH") in ["1", "true"] do
+      [
+        srt_bench: [
+          sources: [
+            "bench/srt_bench.cpp",
+            "server/server.cpp",
+            "server/admission_rules.cpp",
+            "server/ts_inspector.cpp",
+            "client/client.cpp",
+            "client/send_ring.cpp",
+            "common/srt_socket_stats.cpp",
+            "common/latency_histograms.cpp",
+            "common/native_metrics.cpp",
+            "common/command_mailbox.cpp",
+            "common/transfer_options.cpp",
+            "common/socket_options.cpp"
+          ],
+          os_deps: [
+            srt: [
+              {:precompiled, Membrane.PrecompiledDependencyProvider.get_dependency_url(:srt, version: "1.5.4")},
+              :pkg_config
+            ],
+            openssl: :pkg_config
+          ],
+          libs: ["pthread"],
+          interface: :port,
+          language: :cpp,
+          compiler_flags: [
+            "-std=c++17",
+            "-O2"
+          ]
+        ]
+      ]
+    else
+      []
+    end
   end
 end
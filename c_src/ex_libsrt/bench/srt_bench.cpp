@@ -0,0 +1,371 @@
+// Loopback throughput and latency benchmark of the native Server and Client, running without the BEAM.
+//
+// Every combination of the given payload sizes, connection counts and latencies results in a single run
+// printed to stdout as one JSON object per line, so that the results can be tracked across releases.
+//
+// Usage: srt_bench [--payload-sizes 188,1316] [--connections 1,10,100] [--latencies 120]
+//                  [--duration-s 5] [--rate-pps 0] [--workers 1] [--port 9000]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <srt/srt.h>
+#include <sys/resource.h>
+
+#include "../client/client.h"
+#include "../server/server.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// packets start with their send time, so that the receiving side can tell the one-way latency
+constexpr size_t TIMESTAMP_SIZE = sizeof(int64_t);
+constexpr size_t MAX_LATENCY_SAMPLES = 1 << 20;
+constexpr int SEND_QUEUE_CAPACITY = 64;
+
+struct Options {
+  std::vector<int> payload_sizes = {188, 1316};
+  std::vector<int> connections = {1, 10, 100};
+  std::vector<int> latencies_ms = {120};
+  int duration_s = 5;
+  // total target rate across all connections, 0 sends as fast as the send queues accept
+  int rate_pps = 0;
+  int workers = 1;
+  int port = 9000;
+};
+
+struct RunConfig {
+  int payload_size;
+  int connections;
+  int latency_ms;
+};
+
+// Received packets counters and latest one-way latencies, written from the server's workers
+struct Receiver {
+  std::atomic<uint64_t> packets = 0;
+  std::atomic<uint64_t> bytes = 0;
+  std::atomic<uint64_t> latency_samples_count = 0;
+  std::vector<std::atomic<int64_t>> latency_samples_ns;
+
+  Receiver() : latency_samples_ns(MAX_LATENCY_SAMPLES) {}
+
+  void OnPacket(const char* data, int len) {
+    packets.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(static_cast<uint64_t>(len), std::memory_order_relaxed);
+
+    if (static_cast<size_t>(len) < TIMESTAMP_SIZE) {
+      return;
+    }
+
+    int64_t sent_at_ns;
+    std::memcpy(&sent_at_ns, data, TIMESTAMP_SIZE);
+
+    auto index = latency_samples_count.fetch_add(1, std::memory_order_relaxed);
+    latency_samples_ns[index % MAX_LATENCY_SAMPLES].store(NowNs() - sent_at_ns,
+                                                          std::memory_order_relaxed);
+  }
+
+  // the most recent samples, older ones get overwritten
+  std::vector<int64_t> LatencySamples() const {
+    auto count = std::min<uint64_t>(latency_samples_count.load(), MAX_LATENCY_SAMPLES);
+
+    std::vector<int64_t> samples(count);
+    for (size_t i = 0; i < count; i++) {
+      samples[i] = latency_samples_ns[i].load(std::memory_order_relaxed);
+    }
+
+    return samples;
+  }
+
+  static int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch())
+        .count();
+  }
+};
+
+// A client together with the memory of its queued payloads, one buffer per send queue slot
+struct Sender {
+  std::shared_ptr<Client> client;
+  std::vector<std::string> slots;
+
+  bool Send() {
+    return client->Send([this](int slot) {
+      auto& buffer = slots[slot];
+      int64_t now_ns = Receiver::NowNs();
+      std::memcpy(&buffer[0], &now_ns, TIMESTAMP_SIZE);
+
+      return std::string_view(buffer);
+    });
+  }
+};
+
+double CpuSeconds() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+double Percentile(const std::vector<int64_t>& sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+
+  size_t rank = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+
+  return sorted[rank] / 1e3;
+}
+
+std::unique_ptr<Server> StartServer(const Options& options,
+                                    const RunConfig& config,
+                                    int port,
+                                    Receiver& receiver) {
+  auto server = std::make_unique<Server>(options.workers);
+
+  // every benchmark connection gets accepted natively, without a connect request roundtrip
+  auto rules = std::make_shared<AdmissionRules>();
+  rules->AddStreamRule(AdmissionRules::StreamMatch::Prefix, "bench", true);
+  server->SetAdmissionRules(rules);
+
+  server->SetListenBacklog(std::max(config.connections, 5));
+  server->SetOnSocketConnected(
+      [](Server::SrtSocket, Server::ConnectionContext*, const std::string&) {});
+  server->SetOnSocketDisconnected([](Server::SrtSocket, Server::ConnectionContext*) {});
+  server->SetOnConnectRequest([](Server::SrtSocket, const std::string&, const std::string&) {});
+  server->SetOnConnectRequestAdmitted(
+      [](Server::SrtSocket, const std::string&, const std::string&) { return nullptr; });
+  server->SetOnFatalError(
+      [](const std::string& reason) { fprintf(stderr, "server error: %s\n", reason.c_str()); });
+  server->SetOnSocketData([&receiver](Server::SrtSocket,
+                                      Server::ConnectionContext*,
+                                      const char* data,
+                                      int len) { receiver.OnPacket(data, len); });
+  server->SetOnSocketDataBatch(
+      [&receiver](Server::SrtSocket,
+                  Server::ConnectionContext*,
+                  const std::vector<std::string_view>& packets) {
+        for (const auto& packet : packets) {
+          receiver.OnPacket(packet.data(), static_cast<int>(packet.size()));
+        }
+      });
+
+  server->Run("127.0.0.1", port, "", config.latency_ms);
+
+  return server;
+}
+
+std::vector<Sender> StartSenders(const RunConfig& config, int port) {
+  std::vector<Sender> senders(static_cast<size_t>(config.connections));
+
+  for (int i = 0; i < config.connections; i++) {
+    auto& sender = senders[i];
+
+    sender.client = std::make_shared<Client>(SEND_QUEUE_CAPACITY, 1000);
+    sender.slots.assign(static_cast<size_t>(sender.client->SendQueueCapacity()),
+                        std::string(static_cast<size_t>(config.payload_size), 'x'));
+
+    sender.client->SetNonBlockingSend(true, SEND_QUEUE_CAPACITY / 2);
+    sender.client->SetOnSocketConnected([]() {});
+    sender.client->SetOnSocketDisconnected([]() {});
+    sender.client->SetOnSendQueueReady([]() {});
+    sender.client->SetOnSocketError(
+        [](const std::string& reason) { fprintf(stderr, "client error: %s\n", reason.c_str()); });
+
+    sender.client->Run("127.0.0.1", port, "bench-" + std::to_string(i), "", config.latency_ms);
+  }
+
+  return senders;
+}
+
+// Sends from all the clients in a round robin, paced to the target rate if there is one
+uint64_t DriveSenders(std::vector<Sender>& senders, const Options& options) {
+  auto start = Clock::now();
+  auto deadline = start + std::chrono::seconds(options.duration_s);
+
+  uint64_t sent = 0;
+
+  while (Clock::now() < deadline) {
+    bool progressed = false;
+
+    for (auto& sender : senders) {
+      if (options.rate_pps > 0) {
+        double elapsed_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (sent >= static_cast<uint64_t>(elapsed_s * options.rate_pps)) {
+          break;
+        }
+      }
+
+      if (sender.Send()) {
+        sent++;
+        progressed = true;
+      }
+    }
+
+    if (!progressed) {
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  }
+
+  return sent;
+}
+
+void RunBenchmark(const Options& options, const RunConfig& config, int port) {
+  auto receiver = std::make_unique<Receiver>();
+
+  auto server = StartServer(options, config, port, *receiver);
+  auto senders = StartSenders(config, port);
+
+  auto cpu_before = CpuSeconds();
+  auto started_at = Clock::now();
+
+  uint64_t sent = DriveSenders(senders, options);
+
+  // rates cover the sending period only, without the time it takes to wind the run down
+  double elapsed_s = std::chrono::duration<double>(Clock::now() - started_at).count();
+  double cpu_s = CpuSeconds() - cpu_before;
+  uint64_t bytes = receiver->bytes.load();
+  uint64_t packets_in_period = receiver->packets.load();
+
+  // stopping lingers until the queued packets are sent, then the last ones get a moment to arrive
+  for (auto& sender : senders) {
+    sender.client->Stop();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(config.latency_ms + 100));
+
+  for (auto socket : server->ActiveSockets()) {
+    server->CloseConnection(socket);
+  }
+  server->Stop();
+
+  auto latencies = receiver->LatencySamples();
+  std::sort(latencies.begin(), latencies.end());
+
+  uint64_t packets = receiver->packets.load();
+  double mbps = bytes * 8 / elapsed_s / 1e6;
+
+  printf("{\"payload_size\":%d,\"connections\":%d,\"latency_ms\":%d,\"workers\":%d,"
+         "\"rate_pps\":%d,\"elapsed_s\":%.3f,\"packets_sent\":%llu,\"packets_received\":%llu,"
+         "\"pps\":%.1f,\"bytes_per_s\":%.1f,\"mbps\":%.3f,"
+         "\"one_way_latency_us\":{\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"p999\":%.1f,\"max\":%.1f},"
+         "\"cpu_s\":%.3f,\"cpu_percent_per_mbps\":%.4f}\n",
+         config.payload_size,
+         config.connections,
+         config.latency_ms,
+         options.workers,
+         options.rate_pps,
+         elapsed_s,
+         static_cast<unsigned long long>(sent),
+         static_cast<unsigned long long>(packets),
+         packets_in_period / elapsed_s,
+         bytes / elapsed_s,
+         mbps,
+         Percentile(latencies, 0.5),
+         Percentile(latencies, 0.9),
+         Percentile(latencies, 0.99),
+         Percentile(latencies, 0.999),
+         Percentile(latencies, 1.0),
+         cpu_s,
+         mbps > 0 ? cpu_s / elapsed_s * 100 / mbps : 0.0);
+  fflush(stdout);
+}
+
+std::vector<int> ParseList(const std::string& value) {
+  std::vector<int> values;
+  std::stringstream stream(value);
+  std::string item;
+
+  while (std::getline(stream, item, ',')) {
+    values.push_back(std::stoi(item));
+  }
+
+  return values;
+}
+
+Options ParseOptions(int argc, char** argv) {
+  Options options;
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string key = argv[i];
+    std::string value = argv[i + 1];
+
+    if (key == "--payload-sizes") {
+      options.payload_sizes = ParseList(value);
+    } else if (key == "--connections") {
+      options.connections = ParseList(value);
+    } else if (key == "--latencies") {
+      options.latencies_ms = ParseList(value);
+    } else if (key == "--duration-s") {
+      options.duration_s = std::stoi(value);
+    } else if (key == "--rate-pps") {
+      options.rate_pps = std::stoi(value);
+    } else if (key == "--workers") {
+      options.workers = std::stoi(value);
+    } else if (key == "--port") {
+      options.port = std::stoi(value);
+    } else {
+      throw std::invalid_argument("Unknown option " + key);
+    }
+  }
+
+  for (int payload_size : options.payload_sizes) {
+    if (payload_size < static_cast<int>(TIMESTAMP_SIZE) ||
+        payload_size > TransferOptions::DEFAULT_LIVE_PAYLOAD_SIZE) {
+      throw std::invalid_argument("Payload size must be between 8 and " +
+                                  std::to_string(TransferOptions::DEFAULT_LIVE_PAYLOAD_SIZE));
+    }
+  }
+
+  return options;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+
+  try {
+    options = ParseOptions(argc, argv);
+  } catch (const std::exception& e) {
+    fprintf(stderr, "%s\n", e.what());
+
+    return 1;
+  }
+
+  srt_startup();
+  srt_setloglevel(srt_logging::LogLevel::error);
+
+  // each run gets its own port, so that packets of a previous run can't leak into it
+  int port = options.port;
+  int result = 0;
+
+  for (int payload_size : options.payload_sizes) {
+    for (int connections : options.connections) {
+      for (int latency_ms : options.latencies_ms) {
+        try {
+          RunBenchmark(options, RunConfig{payload_size, connections, latency_ms}, port++);
+        } catch (const std::exception& e) {
+          fprintf(stderr, "run failed: %s\n", e.what());
+          result = 1;
+        }
+      }
+    }
+  }
+
+  srt_cleanup();
+
+  return result;
+}
@@ -1,5 +1,6 @@
 #include "client.h"
 
+#include <algorithm>
 #include <cstring>
 #include <exception>
 #include <utility>
@@ -49,6 +50,9 @@ void Client::Run(const std::string& address,
     throw std::runtime_error(std::string(srt_getlasterror_str()));
   }
 
+  // the transmission type resets other options, so it has to be set before them
+  transfer_options.Apply(srt_sock);
+
   int yes = 1;
   int no = 0;
 
@@ -58,7 +62,9 @@ void Client::Run(const std::string& address,
     }
   }
 
-  if (srt_setsockflag(srt_sock, SRTO_SENDER, &yes, sizeof yes) == SRT_ERROR) {
+  int sender = mode == Mode::Sender ? yes : no;
+
+  if (srt_setsockflag(srt_sock, SRTO_SENDER, &sender, sizeof sender) == SRT_ERROR) {
     throw std::runtime_error(std::string(srt_getlasterror_str()));
   }
 
@@ -72,6 +78,9 @@ void Client::Run(const std::string& address,
     }
   }
 
+  // the latency sets the peer latency as well, so the options go after it to take precedence
+  socket_options.Apply(srt_sock);
+
   if (!stream_id.empty()) {
     if (srt_setsockflag(
             srt_sock, SRTO_STREAMID, stream_id.c_str(), stream_id.length()) ==
@@ -92,9 +101,12 @@ void Client::Run(const std::string& address,
     throw std::runtime_error(std::string(srt_getlasterror_str()));
   }
 
-  const int write_modes = SRT_EPOLL_OUT | SRT_EPOLL_ERR;
+  // the sender drains its whole queue per writable event, so it only needs to hear about the socket
+  // becoming writable again after filling up the sender buffer
+  const int modes = mode == Mode::Sender ? SRT_EPOLL_OUT | SRT_EPOLL_ERR | SRT_EPOLL_ET
+                                         : SRT_EPOLL_IN | SRT_EPOLL_ERR;
 
-  if (srt_epoll_add_usock(epoll, srt_sock, &write_modes) == SRT_ERROR) {
+  if (srt_epoll_add_usock(epoll, srt_sock, &modes) == SRT_ERROR) {
     throw std::runtime_error(std::string(srt_getlasterror_str()));
   }
 
@@ -106,41 +118,174 @@ void Client::Run(const std::string& address,
   }
 
   running.store(true);
-  epoll_loop = std::thread(&Client::RunEpoll, this);
-}
 
-void Client::Send(std::unique_ptr<char[]> data, int len) {
-  if (running.load()) {
-    auto lock = std::unique_lock(send_mutex);
-    send_cv.wait(lock,
-                 [&] { return (int)send_queue.size() < max_pending_messages || running.load(); });
+  if (mode == Mode::Receiver) {
+    // connecting is blocking, only receiving must not block the epoll thread
+    if (srt_setsockflag(srt_sock, SRTO_RCVSYN, &no, sizeof no) == SRT_ERROR) {
+      throw std::runtime_error(std::string(srt_getlasterror_str()));
+    }
 
-    send_queue.emplace_back(std::move(data), len);
+    epoll_loop = std::thread(&Client::RunReceiverEpoll, this);
   } else {
+    epoll_loop = std::thread(&Client::RunEpoll, this);
+  }
+}
+
+void Client::SetReceiveBatching(int max_packets, int max_bytes) {
+  batch_max_packets = std::max(max_packets, 1);
+  batch_max_bytes = std::max(max_bytes, TransferOptions::LIVE_RECEIVE_SIZE);
+}
+
+bool Client::Send(const PayloadPin& pin) {
+  if (mode == Mode::Receiver) {
+    throw std::runtime_error("Client is in receiver mode");
+  }
+
+  auto producer_lock = std::unique_lock(producer_mutex);
+
+  while (running.load() && !stopping.load()) {
+    int slot = send_ring.NextSlot();
+
+    if (slot >= 0) {
+      auto payload = ValidatePayload(slot, pin(slot));
+
+      Enqueue(slot, payload);
+      NotifyWaiters();
+
+      return true;
+    }
+
+    if (non_blocking_send) {
+      // the queue might have been drained before arming the notification, so check once again
+      send_queue_ready_armed.store(true);
+
+      if (send_ring.Full()) {
+        return false;
+      }
+
+      continue;
+    }
+
+    // the queued messages would expire before a slot gets freed, give up instead of blocking the caller
+    auto lock = std::unique_lock(wakeup_mutex);
+
+    waiters++;
+    bool sendable = wakeup_cv.wait_for(
+        lock, std::chrono::milliseconds(send_ttl), [&] {
+          return !send_ring.Full() || !running.load() || stopping.load();
+        });
+    waiters--;
+
+    if (!sendable) {
+      throw std::runtime_error("Send queue is full");
+    }
+  }
+
+  throw std::runtime_error("Client is not active");
+}
+
+int Client::SendBatch(int count, const BatchPayloadPin& pin) {
+  if (mode == Mode::Receiver) {
+    throw std::runtime_error("Client is in receiver mode");
+  }
+
+  auto producer_lock = std::unique_lock(producer_mutex);
+
+  if (!running.load() || stopping.load()) {
     throw std::runtime_error("Client is not active");
   }
 
-  send_cv.notify_all();
+  int accepted = 0;
+  bool armed = false;
+
+  while (accepted < count) {
+    int slot = send_ring.NextSlot();
+
+    if (slot >= 0) {
+      auto payload = ValidatePayload(slot, pin(slot, accepted));
+
+      Enqueue(slot, payload);
+      accepted++;
+    } else if (!armed) {
+      // the queue might have been drained before arming the notification, so check once again
+      send_queue_ready_armed.store(true);
+      armed = true;
+    } else {
+      break;
+    }
+  }
+
+  if (accepted > 0) {
+    NotifyWaiters();
+  }
+
+  return accepted;
+}
+
+std::string_view Client::ValidatePayload(int slot, std::string_view payload) {
+  if (payload.size() > static_cast<size_t>(MaxMessageSize())) {
+    ReleasePayload(slot);
+
+    throw std::runtime_error("Message is too large");
+  }
+
+  return payload;
+}
+
+void Client::Enqueue(int slot, std::string_view payload) {
+  // only a fraction of the messages gets timed, the others are left without a timestamp
+  enqueued_at[slot] = enqueued_messages++ % NativeMetrics::TIMING_INTERVAL == 0
+                          ? std::chrono::steady_clock::now()
+                          : std::chrono::steady_clock::time_point{};
+
+  send_ring.Push(payload.data(), static_cast<int>(payload.size()));
+
+  NativeMetrics::Global().client_send_queue_depth.Record(send_ring.Size());
+}
+
+void Client::ReleasePayload(int slot) {
+  if (on_payload_released) {
+    on_payload_released(slot);
+  }
+}
+
+void Client::NotifySendQueueReady() {
+  if (!send_queue_ready_armed.load() || (int)send_ring.Size() > send_queue_low_watermark) {
+    return;
+  }
+
+  if (send_queue_ready_armed.exchange(false) && on_send_queue_ready) {
+    on_send_queue_ready();
+  }
+}
+
+void Client::NotifyWaiters() {
+  if (waiters.load() > 0) {
+    // taking the lock makes sure that the waiter either has not checked its condition yet or is already waiting
+    { auto lock = std::unique_lock(wakeup_mutex); }
+
+    wakeup_cv.notify_all();
+  }
 }
 
 std::unique_ptr<SrtSocketStats> Client::ReadSocketStats(bool clear_intervals) {
   return readSrtSocketStats(srt_sock, clear_intervals);
 }
 
-void Client::Stop() {
-  if (running.load()) {
-    while (true) {
-      auto lock = std::unique_lock(send_mutex);
+Client::SrtSocket Client::Socket() {
+  std::shared_lock<std::shared_mutex> lock(socket_mutex);
 
-      send_cv.wait(lock, [&] { return send_queue.empty() || running.load(); });
+  return running.load() ? srt_sock : -1;
+}
 
-      if (send_queue.empty() || running.load()) {
-        break;
-      }
-    }
+void Client::Stop() {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(linger_ms);
 
-    running.store(false);
-    send_cv.notify_all();
+  if (running.load()) {
+    // the sending thread flushes the send queue on its own and exits once it is empty
+    stop_deadline = deadline;
+    stopping.store(true);
+    NotifyWaiters();
   }
 
   if (epoll_loop.joinable()) {
@@ -153,58 +298,99 @@ void Client::Stop() {
     epoll = -1;
   }
 
-  sleep(1); // workaround to make sure all the packets are sent, as shown here: https://github.com/Haivision/srt/blob/952f9495246abc201bac55b8f9ad7409c0572423/examples/test-c-client.c#L94
   if (srt_sock != -1) {
-    srt_close(srt_sock);
+    DrainSenderBuffer(deadline);
+
+    std::unique_lock<std::shared_mutex> lock(socket_mutex);
 
+    srt_close(srt_sock);
     srt_sock = -1;
   }
 }
 
+bool Client::Forward(const char* data, int len) {
+  std::shared_lock<std::shared_mutex> lock(socket_mutex);
+
+  if (!running.load() || stopping.load() || srt_sock == -1) {
+    return false;
+  }
+
+  if (srt_sendmsg(srt_sock, data, len, MessageTtl(), 0) == SRT_ERROR) {
+    srt_clearlasterror();
+
+    return false;
+  }
+
+  return true;
+}
+
+bool Client::ShouldStopSending() const {
+  return stopping.load() &&
+         (send_ring.Empty() || std::chrono::steady_clock::now() >= stop_deadline);
+}
+
+// Messages accepted by srt_sendmsg may still wait in the sender buffer for being sent or acknowledged,
+// closing the socket right away would drop them. libsrt offers no event for that, so just as its own
+// lingering does, the buffer gets checked every millisecond.
+void Client::DrainSenderBuffer(std::chrono::steady_clock::time_point deadline) {
+  size_t bytes = 0;
+
+  while (srt_getsockstate(srt_sock) == SRTS_CONNECTED &&
+         srt_getsndbuffer(srt_sock, nullptr, &bytes) != SRT_ERROR && bytes > 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
 void Client::RunEpoll() {
   try {
-    while (running.load()) {
-      int read_error_len = 1;
-      int read_out_len = 1;
-      SrtSocket read_error;
-      SrtSocket read_out;
-
-      int n = srt_epoll_wait(epoll,
-                             &read_error,
-                             &read_error_len,
-                             &read_out,
-                             &read_out_len,
-                             200,
-                             0,
-                             0,
-                             0,
-                             0);
-      if (n < 0) {
-        continue;
-      }
+    // the socket stays writable until a send fills up the sender buffer, edge-triggered epoll
+    // reports it again only once there is room in the buffer
+    bool writable = false;
 
-      if (read_out_len > 0 && !connected) {
-        connected = true;
+    while (running.load() && !ShouldStopSending()) {
+      int64_t timeout_ms = 200;
 
-        if (on_socket_connected) {
-          on_socket_connected();
-        }
+      if (connected) {
+        auto now = std::chrono::steady_clock::now();
+        latency_histograms.Sample(srt_sock, now);
+
+        // the wait must not outlast the next sample, so that the histograms get sampled
+        // every SAMPLE_INTERVAL however long the socket stays idle
+        timeout_ms = std::min<int64_t>(timeout_ms, latency_histograms.TimeToNextSample(now).count());
       }
 
-      if (read_error_len > 0 && !connected) {
-        int code = srt_getrejectreason(read_error);
-        auto reason = srt_rejectreason_str(code);
+      if (writable) {
+        // no writable event is coming, the epoll only gets checked for errors
+        timeout_ms = 0;
+      } else if (stopping.load()) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            stop_deadline - std::chrono::steady_clock::now());
 
-        throw std::runtime_error(reason);
+        timeout_ms = std::clamp<int64_t>(remaining.count(), 0, timeout_ms);
       }
 
-      if (read_error_len > 0) {
+      SRT_EPOLL_EVENT event;
+
+      int n = srt_epoll_uwait(epoll, &event, 1, timeout_ms);
+
+      if (n < 1) {
+        // clear out the time out error
+        srt_clearlasterror();
+      } else if (event.events & SRT_EPOLL_ERR) {
+        if (!connected) {
+          int code = srt_getrejectreason(srt_sock);
+          auto reason = srt_rejectreason_str(code);
+
+          throw std::runtime_error(reason);
+        }
+
         int posix_err;
         auto code = srt_getlasterror(&posix_err);
 
         if (code == 0) {
           running.store(false);
-          send_cv.notify_all();
+          NotifyWaiters();
 
           on_socket_disconnected();
 
@@ -214,29 +400,89 @@ void Client::RunEpoll() {
 
           throw std::runtime_error(reason);
         }
+      } else if (event.events & SRT_EPOLL_OUT) {
+        writable = true;
+
+        if (!connected) {
+          connected = true;
+
+          if (on_socket_connected) {
+            on_socket_connected();
+          }
+        }
       }
 
-      if (read_out_len > 0) {
-        auto lock = std::unique_lock(send_mutex);
+      // we are waiting with timeout to make sure that we catch a socket disconnect event even when blocking,
+      // again no longer than until the next sample
+      auto wait_timeout = std::min(std::chrono::milliseconds(500),
+                                   latency_histograms.TimeToNextSample(std::chrono::steady_clock::now()));
 
-        auto sendable = send_cv.wait_for(
-            lock,
-            std::chrono::milliseconds(500),
-            [&] { return !this->send_queue.empty() || !running.load(); });
+      if (writable && WaitForMessages(wait_timeout)) {
+        writable = SendFromQueue();
+      }
+    }
 
-        // we are waiting with timeout to make sure that we catch a socket disconnect event even when blocking
-        if (!sendable) {
-          continue;
-        }
+    running.store(false);
+    NotifyWaiters();
+  } catch (const std::exception& e) {
+    running.store(false);
+    NotifyWaiters();
+
+    if (on_socket_error) {
+      on_socket_error(e.what());
+    }
+  }
+}
+
+void Client::RunReceiverEpoll() {
+  batch_packets.reserve(static_cast<size_t>(batch_max_packets));
+
+  // the connection has been established synchronously before starting the thread
+  connected = true;
+
+  if (on_socket_connected) {
+    on_socket_connected();
+  }
+
+  try {
+    while (running.load() && !stopping.load()) {
+      auto now = std::chrono::steady_clock::now();
+      latency_histograms.Sample(srt_sock, now);
 
-        SendFromQueue();
+      int readable_len = 1;
+      int broken_len = 1;
+      SrtSocket readable;
+      SrtSocket broken;
+
+      // waiting no longer than until the next sample, which also keeps stopping from getting delayed
+      auto timeout_ms = static_cast<int64_t>(latency_histograms.TimeToNextSample(now).count());
+      int n = srt_epoll_wait(epoll, &readable, &readable_len, &broken, &broken_len, timeout_ms, 0, 0, 0, 0);
+
+      if (n < 1) {
+        // clear out the time out error
+        srt_clearlasterror();
+
+        continue;
       }
 
-      send_cv.notify_all();
+      // libsrt reports broken sockets as readable too, receiving is what tells them apart
+      if (!ReceiveSocketData()) {
+        running.store(false);
+        NotifyWaiters();
+
+        if (on_socket_disconnected) {
+          on_socket_disconnected();
+        }
+
+        return;
+      }
     }
+
+    running.store(false);
+    NotifyWaiters();
   } catch (const std::exception& e) {
     running.store(false);
-    send_cv.notify_all();
+    NotifyWaiters();
 
     if (on_socket_error) {
       on_socket_error(e.what());
@@ -244,16 +490,167 @@ void Client::RunEpoll() {
   }
 }
 
-void Client::SendFromQueue() {
-  if (send_queue.empty()) {
-    return;
+bool Client::ReceiveSocketData() {
+  batch_packets.clear();
+
+  // the region has room for one more message in place as long as the byte limit has not been reached
+  int receive_size = transfer_options.ReceiveSize();
+  int region_size = batch_max_bytes + transfer_options.DirectReceiveSize();
+  char* region = ReserveReceiveBuffer(static_cast<size_t>(region_size));
+
+  int offset = 0;
+  bool disconnected = false;
+  // a message that did not fit the rest of the region, left in the scratch buffer
+  std::string_view oversized;
+
+  while ((int)batch_packets.size() < batch_max_packets && offset < batch_max_bytes) {
+    // a message that may not fit the rest of the region gets received into the scratch buffer
+    bool in_place = receive_size <= region_size - offset;
+    if (!in_place && scratch_buffer.size() < static_cast<size_t>(receive_size)) {
+      scratch_buffer.resize(receive_size);
+    }
+
+    char* buffer = in_place ? region + offset : scratch_buffer.data();
+
+    int n = srt_recv(srt_sock, buffer, receive_size);
+
+    if (n == SRT_ERROR && srt_getlasterror(nullptr) == SRT_EASYNCRCV) {
+      // the socket has been drained, clear out the would-block error
+      srt_clearlasterror();
+
+      break;
+    } else if (n == 0 || n == SRT_ERROR) {
+      disconnected = true;
+
+      break;
+    }
+
+    if (n > region_size - offset) {
+      oversized = std::string_view(buffer, n);
+
+      break;
+    }
+
+    if (!in_place) {
+      memcpy(region + offset, buffer, n);
+      buffer = region + offset;
+    }
+
+    batch_packets.emplace_back(buffer, n);
+    offset += n;
+  }
+
+  if (!batch_packets.empty() && on_socket_data_batch) {
+    on_socket_data_batch(batch_packets);
+  }
+
+  if (!oversized.empty() && on_socket_data_batch) {
+    // reserved only once the batch has been delivered, as the reservation may replace the region
+    char* data = ReserveReceiveBuffer(oversized.size());
+    memcpy(data, oversized.data(), oversized.size());
+
+    batch_packets.clear();
+    batch_packets.emplace_back(data, oversized.size());
+
+    on_socket_data_batch(batch_packets);
+  }
+
+  return !disconnected;
+}
+
+char* Client::ReserveReceiveBuffer(size_t size) {
+  if (receive_buffer_provider) {
+    return receive_buffer_provider(size);
+  }
+
+  if (receive_buffer.size() < size) {
+    receive_buffer.resize(size);
+  }
+
+  return receive_buffer.data();
+}
+
+bool Client::WaitForMessages(std::chrono::milliseconds timeout) {
+  if (!send_ring.Empty()) {
+    return true;
   }
 
-  auto [buffer, size] = std::move(send_queue.front());
+  auto lock = std::unique_lock(wakeup_mutex);
+
+  waiters++;
+  bool ready = wakeup_cv.wait_for(lock, timeout, [&] {
+    return !send_ring.Empty() || !running.load() || stopping.load();
+  });
+  waiters--;
+
+  return ready;
+}
+
+bool Client::SendFromQueue() {
+  bool writable = true;
+  bool failed = false;
+  int sent = 0;
 
-  send_queue.pop_front();
+  // bounded by the capacity, so that a producer refilling the queue can't hold off the epoll checks
+  while (sent < send_ring.Capacity()) {
+    int size;
+    int slot;
+    const char* buffer = send_ring.Front(&size, &slot);
 
-  if (srt_sendmsg(srt_sock, buffer.get(), size, send_ttl, 0) == SRT_ERROR) {
+    if (buffer == nullptr) {
+      break;
+    }
+
+    int result;
+    if (transfer_options.message_api) {
+      result = srt_sendmsg(srt_sock, buffer, size, MessageTtl(), 0);
+    } else {
+      // a byte stream may get accepted in parts
+      result = srt_send(srt_sock, buffer + front_offset, size - front_offset);
+    }
+
+    if (result == SRT_ERROR && srt_getlasterror(nullptr) == SRT_EASYNCSND) {
+      // the sender buffer is full, the message stays queued until the next writable event
+      srt_clearlasterror();
+      writable = false;
+
+      break;
+    }
+
+    if (!transfer_options.message_api && result != SRT_ERROR) {
+      front_offset += result;
+
+      if (front_offset < size) {
+        continue;
+      }
+
+      front_offset = 0;
+    }
+
+    if (enqueued_at[slot] != std::chrono::steady_clock::time_point{}) {
+      auto queue_time_us = NativeMetrics::MicrosSince(enqueued_at[slot]);
+      NativeMetrics::Global().client_send_queue_time_us.Record(queue_time_us);
+    }
+
+    // the slot has to be released before popping, as afterwards it can get reused by the producer
+    ReleasePayload(slot);
+    send_ring.Pop();
+    sent++;
+
+    if (result == SRT_ERROR) {
+      failed = true;
+      front_offset = 0;
+
+      break;
+    }
+  }
+
+  if (sent > 0) {
+    NotifyWaiters();
+    NotifySendQueueReady();
+  }
+
+  if (failed) {
     auto state = srt_getsockstate(srt_sock);
 
     if (state == SRTS_CLOSED || state == SRTS_BROKEN) {
@@ -262,4 +659,6 @@ void Client::SendFromQueue() {
       throw std::runtime_error(srt_getlasterror_str());
     }
   }
+
+  return writable;
 }
@@ -1,17 +1,33 @@
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
-#include <deque>
 #include <mutex>
+#include <shared_mutex>
 #include <srt/srt.h>
+#include <string_view>
 #include <thread>
+#include <vector>
+#include "../common/latency_histograms.h"
+#include "../common/native_metrics.h"
+#include "../common/relay_target.h"
+#include "../common/socket_options.h"
 #include "../common/srt_socket_stats.h"
+#include "../common/transfer_options.h"
+#include "send_ring.h"
 #include <functional>
 
-class Client {
+class Client : public RelayTarget {
+  static const int DEFAULT_LINGER_MS = 1000;
+  static const int DEFAULT_BATCH_MAX_PACKETS = 64;
+  static const int DEFAULT_BATCH_MAX_BYTES = 65536;
+
 public:
   using SrtSocket = int;
   using SrtEpoll = int;
 
+  // A sender pushes data to the server, while a receiver pulls a stream from it
+  enum class Mode { Sender, Receiver };
+
 
   class StreamRejectedException : public std::exception {
   public:
@@ -26,8 +42,11 @@ public:
   };
     
 
-  Client(int max_pending_messages, int send_ttl)
-      : max_pending_messages(max_pending_messages), send_ttl(send_ttl) {}
+  Client(int max_pending_messages, int send_ttl, Mode mode = Mode::Sender)
+      : mode(mode),
+        send_ttl(send_ttl),
+        send_ring(max_pending_messages),
+        enqueued_at(static_cast<size_t>(send_ring.Capacity())) {}
 
   ~Client();
 
@@ -36,10 +55,80 @@ public:
            const std::string& stream_id,
            const std::string& password = "",
            int latency_ms = -1);
-  void Send(std::unique_ptr<char[]> data, int len);
+
+  // Messages are not copied into the send queue. Instead, `pin` gets called with the send queue slot
+  // the message is going to occupy and returns the message data, which has to stay valid until
+  // the slot gets passed to the payload released callback.
+  using PayloadPin = std::function<std::string_view(int slot)>;
+  using BatchPayloadPin = std::function<std::string_view(int slot, int index)>;
+
+  // Returns false when the message could not be enqueued because the send queue is full,
+  // which may happen only in the non-blocking mode
+  bool Send(const PayloadPin& pin);
+  // Enqueues as many of the `count` messages as fit into the send queue without waiting,
+  // returns the number of accepted ones. Refusing any of them arms the send queue ready callback.
+  int SendBatch(int count, const BatchPayloadPin& pin);
+
+  int SendQueueCapacity() const { return send_ring.Capacity(); }
+
+  // Only a sender can send messages or forward relayed packets
+  bool IsSender() const { return mode == Mode::Sender; }
+
+  // Sends a relayed packet right away, bypassing the send queue
+  bool Forward(const char* data, int len) override;
   std::unique_ptr<SrtSocketStats> ReadSocketStats(bool clear_intervals);
+
+  // Bucket counts of the rolling RTT and receive buffer delay histograms,
+  // see `RollingHistogram::BUCKET_BOUNDS`
+  std::unique_ptr<LatencyHistogramCounts> ReadLatencyHistograms() { return latency_histograms.Read(); }
+
+  // The connected socket, -1 once the client has been stopped
+  SrtSocket Socket();
+
+  // Stops accepting new messages and returns as soon as both the send queue and the socket's
+  // sender buffer are drained, but no later than after the linger time
   void Stop();
 
+  void SetLinger(int linger_ms) { this->linger_ms = linger_ms; }
+
+  // Has to be set before running the client
+  void SetTransferOptions(const TransferOptions& options) { transfer_options = options; }
+
+  // The largest message that can be sent or received in one piece
+  int MaxMessageSize() const { return transfer_options.MaxMessageSize(); }
+
+  // Has to be set before running the client
+  void SetSocketOptions(const SocketOptions& options) { socket_options = options; }
+
+  // Limits of a single batch of data delivered in the receiver mode
+  void SetReceiveBatching(int max_packets, int max_bytes);
+
+  // Provides memory that received data gets written into, see `Server::SetReceiveBufferProvider`
+  void SetReceiveBufferProvider(std::function<char*(size_t)>&& receive_buffer_provider) {
+    this->receive_buffer_provider = std::move(receive_buffer_provider);
+  }
+
+  void SetOnSocketDataBatch(
+      std::function<void(const std::vector<std::string_view>&)>&& on_socket_data_batch) {
+    this->on_socket_data_batch = std::move(on_socket_data_batch);
+  }
+
+  // In the non-blocking mode a send never waits for a free slot in the send queue.
+  // Whenever a message gets refused, the send queue ready callback fires once the queue
+  // drains down to `low_watermark` messages.
+  void SetNonBlockingSend(bool non_blocking, int low_watermark) {
+    this->non_blocking_send = non_blocking;
+    this->send_queue_low_watermark = low_watermark;
+  }
+
+  void SetOnSendQueueReady(std::function<void()>&& on_send_queue_ready) {
+    this->on_send_queue_ready = std::move(on_send_queue_ready);
+  }
+
+  void SetOnPayloadReleased(std::function<void(int)>&& on_payload_released) {
+    this->on_payload_released = std::move(on_payload_released);
+  }
+
   void
   SetOnSocketError(std::function<void(const std::string&)>&& on_socket_error) {
     this->on_socket_error = std::move(on_socket_error);
@@ -55,27 +144,81 @@ public:
 
 private:
   void RunEpoll();
-  void SendFromQueue();
+  void RunReceiverEpoll();
+  bool ReceiveSocketData();
+  char* ReserveReceiveBuffer(size_t size);
+  bool WaitForMessages(std::chrono::milliseconds timeout);
+  bool ShouldStopSending() const;
+  void DrainSenderBuffer(std::chrono::steady_clock::time_point deadline);
+  // Sends the queued messages until the queue is empty or the sender buffer is full,
+  // returns false in the latter case
+  bool SendFromQueue();
+  void NotifyWaiters();
+  void NotifySendQueueReady();
+  std::string_view ValidatePayload(int slot, std::string_view payload);
+  void Enqueue(int slot, std::string_view payload);
+  void ReleasePayload(int slot);
+  // TTL of the sent messages, the file mode is reliable so its messages never get dropped
+  int MessageTtl() const { return transfer_options.file_mode ? -1 : send_ttl; }
 
 private:
   SrtSocket srt_sock = -1;
+  // guards closing the socket against packets being forwarded from other threads
+  std::shared_mutex socket_mutex;
   std::string password;
 
   std::atomic_bool running;
+  std::atomic_bool stopping = false;
+  std::chrono::steady_clock::time_point stop_deadline;
+  int linger_ms = DEFAULT_LINGER_MS;
   SrtEpoll epoll = -1;
   std::thread epoll_loop;
 
   bool connected = false;
 
+  TransferOptions transfer_options;
+  SocketOptions socket_options;
+
+  // sampled by the epoll thread every SAMPLE_INTERVAL, its waits never outlast the next sample
+  LatencyHistograms latency_histograms;
+
   std::function<void(const std::string&)> on_socket_error;
   std::function<void()> on_socket_connected;
   std::function<void()> on_socket_disconnected;
+  std::function<void()> on_send_queue_ready;
+  std::function<void(int)> on_payload_released;
+  std::function<void(const std::vector<std::string_view>&)> on_socket_data_batch;
+
+private:
+  const Mode mode;
+
+  int batch_max_packets = DEFAULT_BATCH_MAX_PACKETS;
+  int batch_max_bytes = DEFAULT_BATCH_MAX_BYTES;
+  std::function<char*(size_t)> receive_buffer_provider;
+  std::vector<std::string_view> batch_packets;
+  std::vector<char> receive_buffer;
+  // messages that may not fit the reserved region get received here and copied out afterwards
+  std::vector<char> scratch_buffer;
 
 private:
-  const int max_pending_messages;
   const int send_ttl;
 
-  std::mutex send_mutex;
-  std::condition_variable send_cv;
-  std::deque<std::pair<std::unique_ptr<char[]>, int>> send_queue;
+  SendRing send_ring;
+  // bytes of the front message already sent, when transferring a byte stream
+  int front_offset = 0;
+  // written by the producer before pushing to a slot, so it's visible once the consumer sees the slot
+  std::vector<std::chrono::steady_clock::time_point> enqueued_at;
+  // messages enqueued since the client started, guarded by the producer mutex
+  uint64_t enqueued_messages = 0;
+  // the ring accepts a single producer while the client can be fed from many processes
+  std::mutex producer_mutex;
+
+  // used only for sleeping on a full or empty ring, the ring itself is lock-free
+  std::mutex wakeup_mutex;
+  std::condition_variable wakeup_cv;
+  std::atomic_int waiters = 0;
+
+  bool non_blocking_send = false;
+  int send_queue_low_watermark = 0;
+  std::atomic_bool send_queue_ready_armed = false;
 };
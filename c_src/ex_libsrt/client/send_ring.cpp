@@ -0,0 +1,49 @@
+#include "send_ring.h"
+
+#include <algorithm>
+
+SendRing::SendRing(int capacity) : slots(static_cast<size_t>(std::max(capacity, 1))) {}
+
+int SendRing::NextSlot() const {
+  size_t position = tail.load(std::memory_order_relaxed);
+
+  if (position - head.load(std::memory_order_acquire) == slots.size()) {
+    return -1;
+  }
+
+  return static_cast<int>(position % slots.size());
+}
+
+bool SendRing::Push(const char* data, int len) {
+  size_t position = tail.load(std::memory_order_relaxed);
+
+  if (position - head.load(std::memory_order_acquire) == slots.size()) {
+    return false;
+  }
+
+  auto& slot = slots[position % slots.size()];
+
+  slot.data = data;
+  slot.len = len;
+
+  tail.store(position + 1, std::memory_order_seq_cst);
+
+  return true;
+}
+
+const char* SendRing::Front(int* len, int* slot) const {
+  size_t position = head.load(std::memory_order_relaxed);
+
+  if (position == tail.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+
+  *slot = static_cast<int>(position % slots.size());
+  *len = slots[*slot].len;
+
+  return slots[*slot].data;
+}
+
+void SendRing::Pop() {
+  head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded single-producer/single-consumer queue of messages waiting to be sent.
+//
+// The queue only references the messages, their memory has to be kept alive by the producer
+// until the consumer pops them. Slots are preallocated, both pushing and popping are wait-free.
+class SendRing {
+public:
+  explicit SendRing(int capacity);
+
+  // Returns the slot the next pushed message is going to occupy, -1 when the ring is full
+  int NextSlot() const;
+
+  // Returns false when the ring is full
+  bool Push(const char* data, int len);
+
+  // Returns the oldest message without removing it, nullptr when the ring is empty
+  const char* Front(int* len, int* slot) const;
+  void Pop();
+
+  int Capacity() const { return static_cast<int>(slots.size()); }
+  bool Empty() const { return head.load() == tail.load(); }
+  bool Full() const { return tail.load() - head.load() == slots.size(); }
+  size_t Size() const { return tail.load() - head.load(); }
+
+private:
+  struct Slot {
+    const char* data;
+    int len;
+  };
+
+  std::vector<Slot> slots;
+
+  // positions grow monotonically and get wrapped when indexing the slots,
+  // each of them is written by a single side only
+  alignas(64) std::atomic<size_t> head = 0;
+  alignas(64) std::atomic<size_t> tail = 0;
+};
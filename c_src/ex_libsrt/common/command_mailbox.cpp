@@ -0,0 +1,84 @@
+#include "command_mailbox.h"
+
+#include <fcntl.h>
+#include <srt/srt.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+CommandMailbox::~CommandMailbox() {
+  // commands that never got executed are dropped
+  Node* node = head.exchange(nullptr);
+
+  while (node != nullptr) {
+    Node* next = node->next;
+    delete node;
+    node = next;
+  }
+
+  for (int fd : wakeup_fds) {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+}
+
+void CommandMailbox::Watch(int epoll) {
+  if (pipe(wakeup_fds) != 0) {
+    throw std::runtime_error("Failed to create command mailbox");
+  }
+
+  for (int fd : wakeup_fds) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  }
+
+  const int modes = SRT_EPOLL_IN;
+
+  if (srt_epoll_add_ssock(epoll, wakeup_fds[0], &modes) == SRT_ERROR) {
+    throw std::runtime_error(std::string(srt_getlasterror_str()));
+  }
+}
+
+void CommandMailbox::Post(Command command) {
+  Node* node = new Node{std::move(command), nullptr};
+
+  // the node may get executed and freed by the consumer as soon as it gets published,
+  // so it must not be touched afterwards
+  Node* previous = head.load(std::memory_order_relaxed);
+  do {
+    node->next = previous;
+  } while (!head.compare_exchange_weak(
+      previous, node, std::memory_order_release, std::memory_order_relaxed));
+
+  // only the first command of a batch has to wake the consumer, it drains the rest along with it
+  if (previous == nullptr && wakeup_fds[1] != -1) {
+    char byte = 0;
+    (void)!write(wakeup_fds[1], &byte, 1);
+  }
+}
+
+void CommandMailbox::Drain() {
+  // the wakeups get consumed before taking the commands, so that a command posted
+  // meanwhile either gets taken now or leaves a wakeup behind
+  char buffer[64];
+  while (wakeup_fds[0] != -1 && read(wakeup_fds[0], buffer, sizeof buffer) > 0) {
+  }
+
+  Node* node = head.exchange(nullptr, std::memory_order_acquire);
+
+  // commands are pushed to the front, so the taken list has to be reversed
+  Node* ordered = nullptr;
+  while (node != nullptr) {
+    Node* next = node->next;
+    node->next = ordered;
+    ordered = node;
+    node = next;
+  }
+
+  while (ordered != nullptr) {
+    Node* next = ordered->next;
+    ordered->command();
+    delete ordered;
+    ordered = next;
+  }
+}
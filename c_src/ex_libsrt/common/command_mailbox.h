@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+
+// Lock-free queue of commands posted by any thread and executed by a single thread
+// waiting in a libsrt epoll. When watched by the epoll, posting to an empty mailbox wakes
+// the epoll up right away through a pipe registered as a system socket. Otherwise the
+// consumer has to check for pending commands on its own.
+class CommandMailbox {
+public:
+  using Command = std::function<void()>;
+
+  CommandMailbox() = default;
+  ~CommandMailbox();
+
+  CommandMailbox(const CommandMailbox&) = delete;
+  CommandMailbox& operator=(const CommandMailbox&) = delete;
+
+  // Makes the epoll report the mailbox's descriptor as readable whenever commands get posted,
+  // the epoll can't be waited on with srt_epoll_uwait afterwards
+  void Watch(int epoll);
+
+  bool Pending() const { return head.load(std::memory_order_relaxed) != nullptr; }
+
+  void Post(Command command);
+
+  // Executes the posted commands in the order they were posted,
+  // to be called by the epoll's thread once the wakeup descriptor got reported
+  void Drain();
+
+private:
+  struct Node {
+    Command command;
+    Node* next;
+  };
+
+  std::atomic<Node*> head = nullptr;
+  int wakeup_fds[2] = {-1, -1};
+};
@@ -0,0 +1,81 @@
+#include "latency_histograms.h"
+
+#include <algorithm>
+#include <srt/srt.h>
+
+void RollingHistogram::Record(double value, std::chrono::steady_clock::time_point now) {
+  auto bucket = std::lower_bound(BUCKET_BOUNDS.begin(), BUCKET_BOUNDS.end(), value) -
+                BUCKET_BOUNDS.begin();
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  Rotate(now);
+  current[bucket]++;
+}
+
+std::vector<uint64_t> RollingHistogram::Counts(std::chrono::steady_clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  Rotate(now);
+
+  std::vector<uint64_t> counts(BUCKETS);
+  for (size_t i = 0; i < BUCKETS; i++) {
+    counts[i] = current[i] + previous[i];
+  }
+
+  return counts;
+}
+
+void RollingHistogram::Rotate(std::chrono::steady_clock::time_point now) {
+  if (now - window_start < window) {
+    return;
+  }
+
+  // after an idle period longer than a window the previous counts are outdated as well
+  if (now - window_start < 2 * window) {
+    previous = current;
+    window_start += window;
+  } else {
+    previous = {};
+    window_start = now;
+  }
+
+  current = {};
+}
+
+void LatencyHistograms::Sample(int socket, std::chrono::steady_clock::time_point now) {
+  if (now < next_sample_at) {
+    return;
+  }
+
+  next_sample_at = now + SAMPLE_INTERVAL;
+
+  SRT_TRACEBSTATS trace;
+
+  if (srt_bstats(socket, &trace, 0) != 0) {
+    srt_clearlasterror();
+
+    return;
+  }
+
+  rtt.Record(trace.msRTT, now);
+  rcv_buf_delay.Record(trace.msRcvBuf, now);
+}
+
+std::chrono::milliseconds LatencyHistograms::TimeToNextSample(std::chrono::steady_clock::time_point now) const {
+  if (now >= next_sample_at) {
+    return std::chrono::milliseconds(0);
+  }
+
+  return std::chrono::ceil<std::chrono::milliseconds>(next_sample_at - now);
+}
+
+std::unique_ptr<LatencyHistogramCounts> LatencyHistograms::Read() {
+  auto now = std::chrono::steady_clock::now();
+
+  auto counts = std::make_unique<LatencyHistogramCounts>();
+  counts->rtt = rtt.Counts(now);
+  counts->rcv_buf_delay = rcv_buf_delay.Counts(now);
+
+  return counts;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Counts of values recorded within the last one to two windows, grouped into fixed buckets.
+// Recording and reading may happen from different threads.
+class RollingHistogram {
+public:
+  // upper bounds of all the buckets but the last one, which is unbounded
+  static constexpr std::array<double, 12> BUCKET_BOUNDS = {
+      1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+  static constexpr size_t BUCKETS = BUCKET_BOUNDS.size() + 1;
+
+  explicit RollingHistogram(std::chrono::milliseconds window) : window(window) {}
+
+  void Record(double value, std::chrono::steady_clock::time_point now);
+
+  std::vector<uint64_t> Counts(std::chrono::steady_clock::time_point now);
+
+private:
+  void Rotate(std::chrono::steady_clock::time_point now);
+
+private:
+  const std::chrono::milliseconds window;
+
+  std::mutex mutex;
+  std::chrono::steady_clock::time_point window_start;
+  std::array<uint64_t, BUCKETS> current = {};
+  std::array<uint64_t, BUCKETS> previous = {};
+};
+
+struct LatencyHistogramCounts {
+  std::vector<uint64_t> rtt;
+  std::vector<uint64_t> rcv_buf_delay;
+};
+
+// Rolling histograms of a socket's RTT and of the delay of data waiting in its receive buffer,
+// both in milliseconds
+class LatencyHistograms {
+  static constexpr std::chrono::milliseconds WINDOW{5000};
+
+public:
+  static constexpr std::chrono::milliseconds SAMPLE_INTERVAL{100};
+
+  // Records the socket's current values, unless it has been sampled less than SAMPLE_INTERVAL ago.
+  // Meant to be called by the single thread handling the socket.
+  void Sample(int socket, std::chrono::steady_clock::time_point now);
+
+  // Time left until the next sample is due, rounded up to whole milliseconds.
+  std::chrono::milliseconds TimeToNextSample(std::chrono::steady_clock::time_point now) const;
+
+  std::unique_ptr<LatencyHistogramCounts> Read();
+
+private:
+  std::chrono::steady_clock::time_point next_sample_at;
+
+  RollingHistogram rtt{WINDOW};
+  RollingHistogram rcv_buf_delay{WINDOW};
+};
@@ -0,0 +1,57 @@
+#include "native_metrics.h"
+
+void AtomicHistogram::Record(uint64_t value) {
+  int bucket = value == 0 ? 0 : 64 - __builtin_clzll(value);
+  if (bucket >= BUCKETS) {
+    bucket = BUCKETS - 1;
+  }
+
+  buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  count.fetch_add(1, std::memory_order_relaxed);
+  sum.fetch_add(value, std::memory_order_relaxed);
+
+  uint64_t current_max = max.load(std::memory_order_relaxed);
+  while (value > current_max &&
+         !max.compare_exchange_weak(current_max, value, std::memory_order_relaxed)) {
+  }
+}
+
+AtomicHistogram::Summary AtomicHistogram::Summarize() const {
+  // the counters are read one by one, so the summary may be off by the values recorded meanwhile
+  std::array<uint64_t, BUCKETS> counts;
+  uint64_t total = 0;
+
+  for (int i = 0; i < BUCKETS; i++) {
+    counts[i] = buckets[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+
+  auto percentile = [&](double p) -> uint64_t {
+    uint64_t rank = static_cast<uint64_t>(p * total + 0.5);
+    uint64_t seen = 0;
+
+    for (int i = 0; i < BUCKETS; i++) {
+      seen += counts[i];
+
+      if (seen >= rank && seen > 0) {
+        return uint64_t(1) << i;
+      }
+    }
+
+    return 0;
+  };
+
+  Summary summary;
+  summary.count = total;
+  summary.sum = sum.load(std::memory_order_relaxed);
+  summary.max = max.load(std::memory_order_relaxed);
+  summary.p50 = percentile(0.5);
+  summary.p99 = percentile(0.99);
+
+  return summary;
+}
+
+NativeMetrics& NativeMetrics::Global() {
+  static NativeMetrics metrics;
+  return metrics;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Lock-free histogram with power of two buckets, the i-th bucket holds values below 2^i.
+// Meant for recording from hot paths of many threads at once.
+class AtomicHistogram {
+public:
+  static constexpr int BUCKETS = 32;
+
+  struct Summary {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    // upper bounds of the buckets holding the percentiles
+    uint64_t p50;
+    uint64_t p99;
+  };
+
+  void Record(uint64_t value);
+
+  Summary Summarize() const;
+
+private:
+  std::array<std::atomic<uint64_t>, BUCKETS> buckets = {};
+  std::atomic<uint64_t> count = 0;
+  std::atomic<uint64_t> sum = 0;
+  std::atomic<uint64_t> max = 0;
+};
+
+// Process wide counters of the native layer, used for telling the binding's bottlenecks apart from SRT ones
+struct NativeMetrics {
+  // timers of per packet or per message events time only one of every that many events,
+  // so that most of the events cost no clock reads
+  static constexpr uint64_t TIMING_INTERVAL = 64;
+
+  // time spent in the server's data callbacks, in microseconds, sampled from every 64th packet
+  // when not batching and from every batch otherwise
+  AtomicHistogram data_callback_us;
+  // messages that could not be delivered, as their receiver is gone
+  std::atomic<uint64_t> send_failures = 0;
+  // time server workers spent resolving the connection of a socket event, in microseconds,
+  // sampled from every 64th lookup
+  AtomicHistogram connection_lookup_us;
+  // number of messages in the client's send queue right after enqueueing one
+  AtomicHistogram client_send_queue_depth;
+  // time between enqueueing a message in the client and sending it, in microseconds,
+  // sampled from every 64th message
+  AtomicHistogram client_send_queue_time_us;
+  // server worker wakeups with at least one socket event
+  std::atomic<uint64_t> epoll_wakeups = 0;
+  AtomicHistogram packets_per_wakeup;
+
+  static NativeMetrics& Global();
+
+  static uint64_t MicrosSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  }
+};
@@ -0,0 +1,52 @@
+#include "payload_pins.h"
+
+#include <stdexcept>
+
+PayloadPins::PayloadPins(int slots) : envs(slots, nullptr) {
+  for (auto& env : envs) {
+    env = enif_alloc_env();
+  }
+}
+
+PayloadPins::~PayloadPins() {
+  for (auto env : envs) {
+    enif_free_env(env);
+  }
+}
+
+std::string_view PayloadPins::Pin(int slot, UNIFEX_TERM binary) {
+  auto env = envs[slot];
+  ErlNifBinary pinned;
+
+  if (!enif_inspect_binary(env, enif_make_copy(env, binary), &pinned)) {
+    enif_clear_env(env);
+
+    throw std::runtime_error("Payload is not a binary");
+  }
+
+  return std::string_view(reinterpret_cast<const char*>(pinned.data), pinned.size);
+}
+
+void PayloadPins::Release(int slot) {
+  enif_clear_env(envs[slot]);
+}
+
+std::shared_ptr<const std::string_view> PayloadPins::PinShared(UNIFEX_TERM binary) {
+  struct SharedPin {
+    UnifexEnv* env = enif_alloc_env();
+    std::string_view data;
+
+    ~SharedPin() { enif_free_env(env); }
+  };
+
+  auto pin = std::make_shared<SharedPin>();
+  ErlNifBinary pinned;
+
+  if (!enif_inspect_binary(pin->env, enif_make_copy(pin->env, binary), &pinned)) {
+    throw std::runtime_error("Payload is not a binary");
+  }
+
+  pin->data = std::string_view(reinterpret_cast<const char*>(pinned.data), pinned.size);
+
+  return std::shared_ptr<const std::string_view>(pin, &pin->data);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <unifex/unifex.h>
+#include <vector>
+
+// Keeps binaries passed to a NIF alive after the call returns, so that native threads
+// can read them without copying.
+//
+// Each slot owns a process independent environment holding a copy of the pinned term,
+// which for refcounted binaries is just another reference to the same data.
+class PayloadPins {
+public:
+  explicit PayloadPins(int slots);
+  ~PayloadPins();
+
+  PayloadPins(const PayloadPins&) = delete;
+  PayloadPins& operator=(const PayloadPins&) = delete;
+
+  // Pins a binary term in the given slot and returns its data
+  std::string_view Pin(int slot, UNIFEX_TERM binary);
+
+  // Drops the term pinned in the given slot, may be called from any thread
+  void Release(int slot);
+
+  // Pins a binary term for as long as any copy of the returned pointer is alive
+  static std::shared_ptr<const std::string_view> PinShared(UNIFEX_TERM binary);
+
+private:
+  std::vector<UnifexEnv*> envs;
+};
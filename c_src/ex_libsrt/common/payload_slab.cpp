@@ -0,0 +1,40 @@
+#include "payload_slab.h"
+
+#include <algorithm>
+
+ErlNifResourceType* PayloadSlab::resource_type = nullptr;
+
+bool PayloadSlab::Init(UnifexEnv* env) {
+  resource_type = enif_open_resource_type(
+      env, nullptr, "ex_libsrt_payload_slab", nullptr, ERL_NIF_RT_CREATE, nullptr);
+
+  return resource_type != nullptr;
+}
+
+PayloadSlab::~PayloadSlab() {
+  if (slab != nullptr) {
+    enif_release_resource(slab);
+  }
+}
+
+char* PayloadSlab::Reserve(size_t size) {
+  if (slab == nullptr || capacity - offset < size) {
+    if (slab != nullptr) {
+      // binaries created so far keep the old slab alive on their own
+      enif_release_resource(slab);
+    }
+
+    // an oversized region is not shared with any further data
+    capacity = std::max(SLAB_SIZE, size);
+    offset = 0;
+    slab = static_cast<char*>(enif_alloc_resource(resource_type, capacity));
+  }
+
+  return slab + offset;
+}
+
+UNIFEX_TERM PayloadSlab::MakeBinary(UnifexEnv* env, const char* data, size_t size) {
+  offset = std::max(offset, static_cast<size_t>(data + size - slab));
+
+  return enif_make_resource_binary(env, slab, data, size);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <unifex/unifex.h>
+
+// Large refcounted buffer that socket data gets received into directly.
+//
+// Each received packet is handed to the BEAM as a resource binary pointing into the slab,
+// so there is no per-packet allocation nor copy. Bytes that have been handed out are never
+// written again; once the slab runs out of space a new one gets allocated, while the old
+// one is freed by the VM as soon as the last binary referencing it gets garbage collected.
+class PayloadSlab {
+public:
+  static bool Init(UnifexEnv* env);
+
+  PayloadSlab() = default;
+  ~PayloadSlab();
+
+  PayloadSlab(const PayloadSlab&) = delete;
+  PayloadSlab& operator=(const PayloadSlab&) = delete;
+
+  // Returns a region of at least `size` writable bytes. A region larger than a slab gets a dedicated
+  // one of exactly its size, so such regions should only be reserved for data of a known size.
+  char* Reserve(size_t size);
+
+  // Creates a binary term from data previously written into the reserved region
+  UNIFEX_TERM MakeBinary(UnifexEnv* env, const char* data, size_t size);
+
+private:
+  static constexpr size_t SLAB_SIZE = 256 * 1024;
+  static ErlNifResourceType* resource_type;
+
+  char* slab = nullptr;
+  size_t capacity = 0;
+  size_t offset = 0;
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+// Destination of packets relayed natively from a server connection.
+//
+// Packets get forwarded right from the server's worker threads, so implementations
+// have to be thread-safe and must not block.
+class RelayTarget {
+public:
+  virtual ~RelayTarget() = default;
+
+  // Returns false when the packet has been dropped
+  virtual bool Forward(const char* data, int len) = 0;
+};
@@ -0,0 +1,129 @@
+#include "socket_options.h"
+
+#include <cstdint>
+#include <srt/srt.h>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// libsrt's own limits, so that the errors name the option instead of failing on a generic one
+constexpr int MIN_BUFFER_SIZE = 32 * 1500;
+constexpr int MIN_FC = 32;
+constexpr int MIN_MSS = 76;
+constexpr int MAX_MSS = 1500;
+constexpr int MIN_OHEADBW = 5;
+constexpr int MAX_OHEADBW = 100;
+
+void CheckRange(const char* name, int64_t value, int64_t min, int64_t max) {
+  if (value != SocketOptions::UNSET && (value < min || value > max)) {
+    throw std::runtime_error(std::string("Invalid ") + name + " socket option");
+  }
+}
+
+template <typename T>
+void SetFlag(int socket, SRT_SOCKOPT option, T value) {
+  if (value == SocketOptions::UNSET) {
+    return;
+  }
+
+  if (srt_setsockflag(socket, option, &value, sizeof value) == SRT_ERROR) {
+    throw std::runtime_error(std::string(srt_getlasterror_str()));
+  }
+}
+
+// the flags are booleans on libsrt's side
+void SetBoolFlag(int socket, SRT_SOCKOPT option, int value) {
+  if (value == SocketOptions::UNSET) {
+    return;
+  }
+
+  bool flag = value == 1;
+  if (srt_setsockflag(socket, option, &flag, sizeof flag) == SRT_ERROR) {
+    throw std::runtime_error(std::string(srt_getlasterror_str()));
+  }
+}
+
+template <typename T>
+void Override(T& value, const T& override) {
+  if (override != SocketOptions::UNSET) {
+    value = override;
+  }
+}
+
+}  // namespace
+
+void SocketOptions::Validate() const {
+  CheckRange("rcvbuf", rcvbuf, MIN_BUFFER_SIZE, INT32_MAX);
+  CheckRange("sndbuf", sndbuf, MIN_BUFFER_SIZE, INT32_MAX);
+  CheckRange("fc", fc, MIN_FC, INT32_MAX);
+  // 0 means no limit, for the input bandwidth it means estimating it from the sent data
+  CheckRange("maxbw", maxbw, 0, INT64_MAX);
+  CheckRange("inputbw", inputbw, 0, INT64_MAX);
+  CheckRange("oheadbw", oheadbw, MIN_OHEADBW, MAX_OHEADBW);
+  CheckRange("tlpktdrop", tlpktdrop, 0, 1);
+  CheckRange("nakreport", nakreport, 0, 1);
+  CheckRange("peerlatency", peerlatency, 0, INT32_MAX);
+  CheckRange("mss", mss, MIN_MSS, MAX_MSS);
+
+  if (!congestion.empty() && congestion != "live" && congestion != "file") {
+    throw std::runtime_error("Invalid congestion socket option");
+  }
+}
+
+void SocketOptions::Apply(int socket) const {
+  ApplyPreBind(socket);
+  ApplyPostBind(socket);
+}
+
+void SocketOptions::ApplyPreBind(int socket) const {
+  Validate();
+
+  // libsrt bounds the buffers by the segment size and the flow control window, so those go first
+  SetFlag(socket, SRTO_MSS, mss);
+  SetFlag(socket, SRTO_FC, fc);
+  SetFlag(socket, SRTO_RCVBUF, rcvbuf);
+  SetFlag(socket, SRTO_SNDBUF, sndbuf);
+}
+
+void SocketOptions::ApplyPostBind(int socket) const {
+  Validate();
+
+  // the flow control window gets set once more, as a connection may override the listener's one
+  SetFlag(socket, SRTO_FC, fc);
+  SetFlag(socket, SRTO_MAXBW, maxbw);
+  SetFlag(socket, SRTO_INPUTBW, inputbw);
+  SetFlag(socket, SRTO_OHEADBW, oheadbw);
+  SetFlag(socket, SRTO_PEERLATENCY, peerlatency);
+
+  SetBoolFlag(socket, SRTO_TLPKTDROP, tlpktdrop);
+  SetBoolFlag(socket, SRTO_NAKREPORT, nakreport);
+
+  if (!congestion.empty() &&
+      srt_setsockflag(socket, SRTO_CONGESTION, congestion.c_str(), congestion.size()) ==
+          SRT_ERROR) {
+    throw std::runtime_error(std::string(srt_getlasterror_str()));
+  }
+}
+
+SocketOptions SocketOptions::OverriddenBy(const SocketOptions& overrides) const {
+  if (overrides.mss != UNSET || overrides.rcvbuf != UNSET || overrides.sndbuf != UNSET) {
+    throw std::runtime_error("mss, rcvbuf and sndbuf socket options can't be set per connection");
+  }
+
+  SocketOptions result = *this;
+
+  Override(result.fc, overrides.fc);
+  Override(result.maxbw, overrides.maxbw);
+  Override(result.inputbw, overrides.inputbw);
+  Override(result.oheadbw, overrides.oheadbw);
+  Override(result.tlpktdrop, overrides.tlpktdrop);
+  Override(result.nakreport, overrides.nakreport);
+  Override(result.peerlatency, overrides.peerlatency);
+
+  if (!overrides.congestion.empty()) {
+    result.congestion = overrides.congestion;
+  }
+
+  return result;
+}
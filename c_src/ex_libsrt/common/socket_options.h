@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Performance related socket options, each of them left at libsrt's default unless set.
+//
+// All of them but the bandwidth limits have to be set before the socket gets connected.
+// The segment size and the buffer sizes have to be set even before the socket gets bound,
+// so a server sets them on its listening socket, which the accepted sockets inherit them from,
+// while the rest can still be set on an accepted socket from within the listener callback.
+struct SocketOptions {
+  static constexpr int UNSET = -1;
+
+  // buffer sizes in bytes, see SRTO_RCVBUF and SRTO_SNDBUF
+  int rcvbuf = UNSET;
+  int sndbuf = UNSET;
+  // flow control window in packets, see SRTO_FC
+  int fc = UNSET;
+  // bandwidth limits in bytes per second, see SRTO_MAXBW and SRTO_INPUTBW
+  int64_t maxbw = UNSET;
+  int64_t inputbw = UNSET;
+  // recovery bandwidth overhead above the input rate in percent, see SRTO_OHEADBW
+  int oheadbw = UNSET;
+  // boolean flags, 0 or 1
+  int tlpktdrop = UNSET;
+  int nakreport = UNSET;
+  int peerlatency = UNSET;
+  // congestion controller, either "live" or "file", empty when unset
+  std::string congestion;
+  int mss = UNSET;
+
+  // Throws std::runtime_error naming the first option out of its range
+  void Validate() const;
+
+  // Sets the options that are set, throws std::runtime_error when libsrt refuses any of them
+  void Apply(int socket) const;
+
+  // Same as `Apply`, but limited to the options that have to be set before binding the socket
+  void ApplyPreBind(int socket) const;
+
+  // Same as `Apply`, but limited to the options that can still be set on a bound socket
+  void ApplyPostBind(int socket) const;
+
+  // Options of `overrides` that are set take precedence over these ones.
+  // Throws std::runtime_error when `overrides` set any of the pre-bind options,
+  // as those can't differ between the connections of a single listener.
+  SocketOptions OverriddenBy(const SocketOptions& overrides) const;
+};
@@ -1,5 +1,6 @@
 #include "srt_socket_stats.h"
 
+#include <algorithm>
 #include <srt/srt.h>
 
 std::unique_ptr<SrtSocketStats> readSrtSocketStats(int socket, bool clean_intervals) {
@@ -64,7 +65,97 @@ std::unique_ptr<SrtSocketStats> readSrtSocketStats(int socket, bool clean_interv
   stats->pktRcvBelated = trace.pktRcvBelated;
   stats->pktSndDrop = trace.pktSndDrop;
   stats->pktRcvDrop = trace.pktRcvDrop;
+  stats->msRTT = trace.msRTT;
+  stats->mbpsBandwidth = trace.mbpsBandwidth;
+  stats->mbpsMaxBW = trace.mbpsMaxBW;
+  stats->pktFlightSize = trace.pktFlightSize;
+  stats->pktCongestionWindow = trace.pktCongestionWindow;
+  stats->byteAvailSndBuf = trace.byteAvailSndBuf;
+  stats->byteAvailRcvBuf = trace.byteAvailRcvBuf;
+  stats->msSndBuf = trace.msSndBuf;
+  stats->msRcvBuf = trace.msRcvBuf;
+  stats->msSndTsbPdDelay = trace.msSndTsbPdDelay;
+  stats->msRcvTsbPdDelay = trace.msRcvTsbPdDelay;
 
   return stats;
 }
 
+
+static SrtStatsDistribution summarize(std::vector<double>& values) {
+  if (values.empty()) {
+    return {0, 0, 0, 0};
+  }
+
+  // the nearest rank is the smallest one covering at least the given percent of the values,
+  // computed on integers so that no rounding error shifts it
+  auto percentile = [&values](size_t percent) {
+    size_t rank = std::max<size_t>((percent * values.size() + 99) / 100, 1);
+    auto nth = values.begin() + (rank - 1);
+    std::nth_element(values.begin(), nth, values.end());
+
+    return *nth;
+  };
+
+  SrtStatsDistribution distribution;
+
+  // the extremes have to be read first, as selecting the percentiles reorders the values
+  auto [min, max] = std::minmax_element(values.begin(), values.end());
+  distribution.min = *min;
+  distribution.max = *max;
+  distribution.p50 = percentile(50);
+  distribution.p99 = percentile(99);
+
+  return distribution;
+}
+
+std::unique_ptr<SrtAggregateStats> readSrtAggregateStats(const std::vector<int>& sockets) {
+  auto stats = std::make_unique<SrtAggregateStats>();
+  *stats = {};
+
+  std::vector<double> rtts;
+  std::vector<double> bandwidths;
+  std::vector<double> rcv_buf_fills;
+
+  rtts.reserve(sockets.size());
+  bandwidths.reserve(sockets.size());
+  rcv_buf_fills.reserve(sockets.size());
+
+  for (int socket : sockets) {
+    SRT_TRACEBSTATS trace;
+
+    // the interval counters are left intact, as they belong to the per socket reads
+    if (srt_bstats(socket, &trace, 0) != 0) {
+      srt_clearlasterror();
+
+      continue;
+    }
+
+    stats->connections++;
+    stats->pktSentTotal += trace.pktSentTotal;
+    stats->pktRecvTotal += trace.pktRecvTotal;
+    stats->pktSndLossTotal += trace.pktSndLossTotal;
+    stats->pktRcvLossTotal += trace.pktRcvLossTotal;
+    stats->pktRetransTotal += trace.pktRetransTotal;
+    stats->pktSndDropTotal += trace.pktSndDropTotal;
+    stats->pktRcvDropTotal += trace.pktRcvDropTotal;
+    stats->byteSentTotal += trace.byteSentTotal;
+    stats->byteRecvTotal += trace.byteRecvTotal;
+    stats->byteRetransTotal += trace.byteRetransTotal;
+    stats->byteSndDropTotal += trace.byteSndDropTotal;
+    stats->byteRcvDropTotal += trace.byteRcvDropTotal;
+    stats->mbpsSendRate += trace.mbpsSendRate;
+    stats->mbpsRecvRate += trace.mbpsRecvRate;
+
+    rtts.push_back(trace.msRTT);
+    bandwidths.push_back(trace.mbpsBandwidth);
+
+    double rcv_buf_size = static_cast<double>(trace.byteRcvBuf) + trace.byteAvailRcvBuf;
+    rcv_buf_fills.push_back(rcv_buf_size > 0 ? trace.byteRcvBuf * 100.0 / rcv_buf_size : 0);
+  }
+
+  stats->msRTT = summarize(rtts);
+  stats->mbpsBandwidth = summarize(bandwidths);
+  stats->rcvBufFill = summarize(rcv_buf_fills);
+
+  return stats;
+}
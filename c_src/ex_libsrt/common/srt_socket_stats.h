@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 struct SrtSocketStats {
   int64_t msTimeStamp;
@@ -55,7 +56,52 @@ struct SrtSocketStats {
   int64_t pktRcvBelated;
   int32_t pktSndDrop;
   int32_t pktRcvDrop;
+  double msRTT;
+  double mbpsBandwidth;
+  double mbpsMaxBW;
+  int32_t pktFlightSize;
+  int32_t pktCongestionWindow;
+  int32_t byteAvailSndBuf;
+  int32_t byteAvailRcvBuf;
+  int32_t msSndBuf;
+  int32_t msRcvBuf;
+  int32_t msSndTsbPdDelay;
+  int32_t msRcvTsbPdDelay;
 };
 
 std::unique_ptr<SrtSocketStats> readSrtSocketStats(int socket, bool clean_intervals);
 
+// Summary of a value's distribution across sockets, percentiles use the nearest rank
+struct SrtStatsDistribution {
+  double min;
+  double p50;
+  double p99;
+  double max;
+};
+
+// Statistics summed over many sockets
+struct SrtAggregateStats {
+  int32_t connections;
+  int64_t pktSentTotal;
+  int64_t pktRecvTotal;
+  int64_t pktSndLossTotal;
+  int64_t pktRcvLossTotal;
+  int64_t pktRetransTotal;
+  int64_t pktSndDropTotal;
+  int64_t pktRcvDropTotal;
+  uint64_t byteSentTotal;
+  uint64_t byteRecvTotal;
+  uint64_t byteRetransTotal;
+  uint64_t byteSndDropTotal;
+  uint64_t byteRcvDropTotal;
+  double mbpsSendRate;
+  double mbpsRecvRate;
+  SrtStatsDistribution msRTT;
+  SrtStatsDistribution mbpsBandwidth;
+  // percentage of the receive buffer occupied by data waiting for delivery
+  SrtStatsDistribution rcvBufFill;
+};
+
+// Reads statistics of each socket once, sockets that can't be read are skipped
+std::unique_ptr<SrtAggregateStats> readSrtAggregateStats(const std::vector<int>& sockets);
+
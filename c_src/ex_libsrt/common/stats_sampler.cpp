@@ -0,0 +1,142 @@
+#include "stats_sampler.h"
+
+#include <srt/srt.h>
+#include <utility>
+
+StatsSampler::StatsSampler(int interval_ms,
+                           SocketsProvider sockets_provider,
+                           SamplesCallback on_samples)
+    : interval(interval_ms),
+      sockets_provider(std::move(sockets_provider)),
+      on_samples(std::move(on_samples)) {}
+
+StatsSampler::~StatsSampler() {
+  Stop();
+}
+
+void StatsSampler::Start() {
+  sampling_thread = std::thread(&StatsSampler::Run, this);
+}
+
+void StatsSampler::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(stop_mutex);
+    stopped = true;
+  }
+
+  stop_cv.notify_all();
+
+  if (sampling_thread.joinable()) {
+    sampling_thread.join();
+  }
+}
+
+void StatsSampler::Run() {
+  auto next_sample_at = std::chrono::steady_clock::now() + interval;
+
+  std::unique_lock<std::mutex> lock(stop_mutex);
+
+  while (!stop_cv.wait_until(lock, next_sample_at, [this] { return stopped; })) {
+    lock.unlock();
+
+    auto now = std::chrono::steady_clock::now();
+    samples.clear();
+
+    for (int socket : sockets_provider()) {
+      SrtStatsSample sample;
+
+      if (Sample(socket, now, sample)) {
+        samples.push_back(sample);
+      }
+    }
+
+    // forget the sockets that are gone, so that their totals don't pile up
+    for (auto it = previous_totals.begin(); it != previous_totals.end();) {
+      if (it->second.at != now) {
+        it = previous_totals.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    if (!samples.empty() && on_samples) {
+      on_samples(samples);
+    }
+
+    // a late sample shifts the following ones instead of firing them in a row
+    next_sample_at += interval;
+    if (next_sample_at < now) {
+      next_sample_at = now + interval;
+    }
+
+    lock.lock();
+  }
+}
+
+bool StatsSampler::Sample(int socket,
+                          std::chrono::steady_clock::time_point now,
+                          SrtStatsSample& sample) {
+  SRT_TRACEBSTATS trace;
+
+  // the interval counters are left intact, as they may be read on demand as well
+  if (srt_bstats(socket, &trace, 0) != 0) {
+    srt_clearlasterror();
+
+    return false;
+  }
+
+  Totals current = {now,
+                    trace.pktSentTotal,
+                    trace.pktRecvTotal,
+                    trace.pktSndLossTotal,
+                    trace.pktRcvLossTotal,
+                    trace.pktRetransTotal,
+                    trace.pktSndDropTotal,
+                    trace.pktRcvDropTotal,
+                    trace.byteSentTotal,
+                    trace.byteRecvTotal};
+
+  Totals previous = {};
+
+  auto it = previous_totals.find(socket);
+  if (it != previous_totals.end()) {
+    previous = it->second;
+  } else {
+    // the first sample of a socket covers its whole lifetime
+    previous.at = now - std::chrono::milliseconds(trace.msTimeStamp);
+  }
+
+  previous_totals[socket] = current;
+
+  auto elapsed = now - previous.at;
+  double seconds = std::chrono::duration<double>(elapsed).count();
+
+  sample.socket = socket;
+  sample.msInterval = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+  sample.pktSent = current.pktSent - previous.pktSent;
+  sample.pktRecv = current.pktRecv - previous.pktRecv;
+  sample.pktSndLoss = current.pktSndLoss - previous.pktSndLoss;
+  sample.pktRcvLoss = current.pktRcvLoss - previous.pktRcvLoss;
+  sample.pktRetrans = current.pktRetrans - previous.pktRetrans;
+  sample.pktSndDrop = current.pktSndDrop - previous.pktSndDrop;
+  sample.pktRcvDrop = current.pktRcvDrop - previous.pktRcvDrop;
+  sample.byteSent = current.byteSent - previous.byteSent;
+  sample.byteRecv = current.byteRecv - previous.byteRecv;
+
+  if (seconds > 0) {
+    sample.pktSendRate = sample.pktSent / seconds;
+    sample.pktRecvRate = sample.pktRecv / seconds;
+    sample.mbpsSendRate = sample.byteSent * 8 / seconds / 1e6;
+    sample.mbpsRecvRate = sample.byteRecv * 8 / seconds / 1e6;
+  } else {
+    sample.pktSendRate = 0;
+    sample.pktRecvRate = 0;
+    sample.mbpsSendRate = 0;
+    sample.mbpsRecvRate = 0;
+  }
+
+  sample.msRTT = trace.msRTT;
+  sample.mbpsBandwidth = trace.mbpsBandwidth;
+
+  return true;
+}
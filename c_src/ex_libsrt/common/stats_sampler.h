@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Statistics of a single socket gathered over one sampling interval.
+//
+// Counters are deltas of libsrt's totals since the previous sample, rates are computed
+// from these deltas and the actual length of the interval.
+struct SrtStatsSample {
+  int socket;
+  int64_t msInterval;
+  int64_t pktSent;
+  int64_t pktRecv;
+  int32_t pktSndLoss;
+  int32_t pktRcvLoss;
+  int32_t pktRetrans;
+  int32_t pktSndDrop;
+  int32_t pktRcvDrop;
+  uint64_t byteSent;
+  uint64_t byteRecv;
+  double pktSendRate;
+  double pktRecvRate;
+  double mbpsSendRate;
+  double mbpsRecvRate;
+  double msRTT;
+  double mbpsBandwidth;
+};
+
+// Periodically reads statistics of all the sockets returned by the sockets provider
+// and passes them at once to the samples callback, from a separate thread.
+class StatsSampler {
+public:
+  using SocketsProvider = std::function<std::vector<int>()>;
+  using SamplesCallback = std::function<void(const std::vector<SrtStatsSample>&)>;
+
+  StatsSampler(int interval_ms, SocketsProvider sockets_provider, SamplesCallback on_samples);
+  ~StatsSampler();
+
+  StatsSampler(const StatsSampler&) = delete;
+  StatsSampler& operator=(const StatsSampler&) = delete;
+
+  void Start();
+
+  // Returns without waiting for the current interval to end
+  void Stop();
+
+private:
+  struct Totals {
+    std::chrono::steady_clock::time_point at;
+    int64_t pktSent;
+    int64_t pktRecv;
+    int32_t pktSndLoss;
+    int32_t pktRcvLoss;
+    int32_t pktRetrans;
+    int32_t pktSndDrop;
+    int32_t pktRcvDrop;
+    uint64_t byteSent;
+    uint64_t byteRecv;
+  };
+
+  void Run();
+  bool Sample(int socket, std::chrono::steady_clock::time_point now, SrtStatsSample& sample);
+
+private:
+  const std::chrono::milliseconds interval;
+  SocketsProvider sockets_provider;
+  SamplesCallback on_samples;
+
+  // totals from the previous sample of each socket, only accessed by the sampling thread
+  std::unordered_map<int, Totals> previous_totals;
+  std::vector<SrtStatsSample> samples;
+
+  bool stopped = false;
+  std::mutex stop_mutex;
+  std::condition_variable stop_cv;
+  std::thread sampling_thread;
+};
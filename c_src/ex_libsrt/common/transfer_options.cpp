@@ -0,0 +1,59 @@
+#include "transfer_options.h"
+
+#include <algorithm>
+#include <srt/srt.h>
+#include <stdexcept>
+#include <string>
+
+void TransferOptions::Validate() const {
+  if (payload_size < 0 || payload_size > MAX_PAYLOAD_SIZE) {
+    throw std::runtime_error("Payload size must be between 0 and " + std::to_string(MAX_PAYLOAD_SIZE));
+  }
+
+  if (max_message_size < 0 || max_message_size > MAX_FILE_MESSAGE_SIZE) {
+    throw std::runtime_error("Max message size must be between 0 and " +
+                             std::to_string(MAX_FILE_MESSAGE_SIZE));
+  }
+
+  if (!file_mode && !message_api) {
+    throw std::runtime_error("Live mode requires the message API");
+  }
+}
+
+void TransferOptions::Apply(int socket) const {
+  Validate();
+
+  // the transmission type resets the other options to its own defaults, so it goes first
+  SRT_TRANSTYPE transtype = file_mode ? SRTT_FILE : SRTT_LIVE;
+  if (srt_setsockflag(socket, SRTO_TRANSTYPE, &transtype, sizeof transtype) == SRT_ERROR) {
+    throw std::runtime_error(std::string(srt_getlasterror_str()));
+  }
+
+  int message_api_flag = message_api ? 1 : 0;
+  if (srt_setsockflag(socket, SRTO_MESSAGEAPI, &message_api_flag, sizeof message_api_flag) ==
+      SRT_ERROR) {
+    throw std::runtime_error(std::string(srt_getlasterror_str()));
+  }
+
+  if (payload_size > 0 &&
+      srt_setsockflag(socket, SRTO_PAYLOADSIZE, &payload_size, sizeof payload_size) == SRT_ERROR) {
+    throw std::runtime_error(std::string(srt_getlasterror_str()));
+  }
+}
+
+int TransferOptions::MaxMessageSize() const {
+  if (!file_mode) {
+    return payload_size > 0 ? payload_size : DEFAULT_LIVE_PAYLOAD_SIZE;
+  }
+
+  return max_message_size > 0 ? max_message_size : DEFAULT_FILE_MESSAGE_SIZE;
+}
+
+int TransferOptions::ReceiveSize() const {
+  // without the message API a receive returns whatever fits, so the buffer only bounds a single read
+  return file_mode ? MaxMessageSize() : LIVE_RECEIVE_SIZE;
+}
+
+int TransferOptions::DirectReceiveSize() const {
+  return std::min(ReceiveSize(), MAX_DIRECT_RECEIVE_SIZE);
+}
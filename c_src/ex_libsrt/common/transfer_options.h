@@ -0,0 +1,43 @@
+#pragma once
+
+// Transmission settings of SRT sockets, see SRTO_TRANSTYPE, SRTO_PAYLOADSIZE and SRTO_MESSAGEAPI.
+//
+// The live mode sends each message as a single packet, while the file mode splits messages
+// into as many packets as needed and trades latency for throughput.
+struct TransferOptions {
+  // libsrt's default payload of a live mode packet, fitting 7 MPEG-TS packets
+  static constexpr int DEFAULT_LIVE_PAYLOAD_SIZE = 1316;
+  static constexpr int MAX_PAYLOAD_SIZE = 1456;
+  static constexpr int DEFAULT_FILE_MESSAGE_SIZE = 64 * 1024;
+  static constexpr int MAX_FILE_MESSAGE_SIZE = 16 * 1024 * 1024;
+  // no live mode packet gets bigger than that, whatever payload size the peer has chosen
+  static constexpr int LIVE_RECEIVE_SIZE = 1500;
+  // largest region reserved for receiving a single message in place, see `DirectReceiveSize`
+  static constexpr int MAX_DIRECT_RECEIVE_SIZE = 64 * 1024;
+
+  bool file_mode = false;
+  // maximum payload of a single packet, 0 keeps libsrt's default of the mode
+  int payload_size = 0;
+  // without the message API the file mode transfers a byte stream, the live mode requires it
+  bool message_api = true;
+  // largest message sent or received in one piece in the file mode, 0 means the default
+  int max_message_size = 0;
+
+  // Throws std::runtime_error when the options don't fit together
+  void Validate() const;
+
+  // Sets the options on a socket that has not been connected yet, throws std::runtime_error on failure.
+  // Accepted sockets inherit the options of their listener.
+  void Apply(int socket) const;
+
+  // The largest message that can be sent in one piece
+  int MaxMessageSize() const;
+
+  // Size of the buffer a single receive has to be given, so that no message gets truncated
+  int ReceiveSize() const;
+
+  // Size of the region reserved for receiving a single message in place. When it is smaller than
+  // `ReceiveSize`, messages get received into a scratch buffer and only their actual bytes get copied out,
+  // so that a small message does not keep a region of the maximum message size alive.
+  int DirectReceiveSize() const;
+};
@@ -0,0 +1,200 @@
+#include "admission_rules.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <srt/srt.h>
+
+static const char* ACCESS_CONTROL_PREFIX = "#!::";
+
+void AdmissionRules::AddAllowedPeer(const std::string& cidr) {
+  allowed_peers.push_back(ParseNetwork(cidr));
+}
+
+void AdmissionRules::AddDeniedPeer(const std::string& cidr) {
+  denied_peers.push_back(ParseNetwork(cidr));
+}
+
+void AdmissionRules::AddStreamRule(AdmissionRules::StreamMatch match,
+                                   const std::string& pattern,
+                                   bool accept) {
+  StreamRule rule{match, pattern, {}, accept};
+
+  if (match == StreamMatch::AccessControl) {
+    rule.keys = ParseKeyValues(pattern);
+
+    if (rule.keys.empty()) {
+      throw std::runtime_error("Invalid access control pattern: " + pattern);
+    }
+  }
+
+  stream_rules.push_back(std::move(rule));
+}
+
+AdmissionRules::Verdict AdmissionRules::Evaluate(const sockaddr* peer,
+                                                 const std::string& stream_id,
+                                                 int active_connections) const {
+  if (max_connections > 0 && active_connections >= max_connections) {
+    return {Decision::Reject, SRT_REJC_PREDEFINED + 402};
+  }
+
+  for (const auto& network : denied_peers) {
+    if (NetworkContains(network, peer)) {
+      return {Decision::Reject, SRT_REJC_PREDEFINED + 403};
+    }
+  }
+
+  if (!allowed_peers.empty()) {
+    bool allowed = false;
+
+    for (const auto& network : allowed_peers) {
+      if (NetworkContains(network, peer)) {
+        allowed = true;
+        break;
+      }
+    }
+
+    if (!allowed) {
+      return {Decision::Reject, SRT_REJC_PREDEFINED + 403};
+    }
+  }
+
+  std::map<std::string, std::string> access_control;
+  if (stream_id.rfind(ACCESS_CONTROL_PREFIX, 0) == 0) {
+    access_control = ParseKeyValues(stream_id.substr(strlen(ACCESS_CONTROL_PREFIX)));
+  }
+
+  for (const auto& rule : stream_rules) {
+    if (StreamRuleMatches(rule, stream_id, access_control)) {
+      if (rule.accept) {
+        return {Decision::Accept, 0};
+      }
+
+      return {Decision::Reject, SRT_REJC_PREDEFINED + 403};
+    }
+  }
+
+  return {Decision::Undecided, 0};
+}
+
+AdmissionRules::Network AdmissionRules::ParseNetwork(const std::string& cidr) {
+  Network network;
+  memset(&network, 0, sizeof(network));
+
+  auto slash = cidr.find('/');
+  auto address = cidr.substr(0, slash);
+
+  int max_prefix_len;
+
+  if (inet_pton(AF_INET, address.c_str(), network.address) == 1) {
+    network.family = AF_INET;
+    max_prefix_len = 32;
+  } else if (inet_pton(AF_INET6, address.c_str(), network.address) == 1) {
+    network.family = AF_INET6;
+    max_prefix_len = 128;
+  } else {
+    throw std::runtime_error("Invalid network address: " + cidr);
+  }
+
+  network.prefix_len = max_prefix_len;
+
+  if (slash != std::string::npos) {
+    try {
+      network.prefix_len = std::stoi(cidr.substr(slash + 1));
+    } catch (const std::exception&) {
+      throw std::runtime_error("Invalid network prefix: " + cidr);
+    }
+
+    if (network.prefix_len < 0 || network.prefix_len > max_prefix_len) {
+      throw std::runtime_error("Invalid network prefix: " + cidr);
+    }
+  }
+
+  return network;
+}
+
+bool AdmissionRules::NetworkContains(const AdmissionRules::Network& network, const sockaddr* peer) {
+  const unsigned char* address;
+  int family = peer->sa_family;
+
+  if (family == AF_INET) {
+    address = reinterpret_cast<const unsigned char*>(
+        &reinterpret_cast<const sockaddr_in*>(peer)->sin_addr);
+  } else if (family == AF_INET6) {
+    auto* ipv6 = &reinterpret_cast<const sockaddr_in6*>(peer)->sin6_addr;
+
+    // IPv4 peers connecting to a dual stack socket are reported as mapped addresses
+    if (IN6_IS_ADDR_V4MAPPED(ipv6)) {
+      family = AF_INET;
+      address = reinterpret_cast<const unsigned char*>(ipv6) + 12;
+    } else {
+      address = reinterpret_cast<const unsigned char*>(ipv6);
+    }
+  } else {
+    return false;
+  }
+
+  if (family != network.family) {
+    return false;
+  }
+
+  int full_bytes = network.prefix_len / 8;
+  int remaining_bits = network.prefix_len % 8;
+
+  if (memcmp(address, network.address, full_bytes) != 0) {
+    return false;
+  }
+
+  if (remaining_bits > 0) {
+    unsigned char mask = static_cast<unsigned char>(0xFF << (8 - remaining_bits));
+
+    return (address[full_bytes] & mask) == (network.address[full_bytes] & mask);
+  }
+
+  return true;
+}
+
+bool AdmissionRules::StreamRuleMatches(const AdmissionRules::StreamRule& rule,
+                                       const std::string& stream_id,
+                                       const std::map<std::string, std::string>& access_control) {
+  switch (rule.match) {
+  case StreamMatch::Exact:
+    return stream_id == rule.pattern;
+  case StreamMatch::Prefix:
+    return stream_id.rfind(rule.pattern, 0) == 0;
+  case StreamMatch::AccessControl:
+    for (const auto& [key, value] : rule.keys) {
+      auto it = access_control.find(key);
+
+      if (it == std::end(access_control) || it->second != value) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+std::map<std::string, std::string> AdmissionRules::ParseKeyValues(const std::string& list) {
+  std::map<std::string, std::string> keys;
+
+  size_t start = 0;
+  while (start <= list.size()) {
+    auto end = list.find(',', start);
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+
+    auto pair = list.substr(start, end - start);
+    auto separator = pair.find('=');
+
+    if (separator != std::string::npos && separator > 0) {
+      keys[pair.substr(0, separator)] = pair.substr(separator + 1);
+    }
+
+    start = end + 1;
+  }
+
+  return keys;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <arpa/inet.h>
+}
+
+// Set of rules deciding about incoming connect requests without involving the BEAM.
+//
+// Rules are evaluated in the following order:
+// 1. exceeding the maximum number of connections rejects the request
+// 2. a peer matching any of the denied networks gets rejected
+// 3. a peer not matching any of the allowed networks (if there are any) gets rejected
+// 4. the first stream rule matching the stream id decides about the request
+//
+// A request that is not decided by any of the above stays undecided.
+class AdmissionRules {
+public:
+  enum class Decision { Accept, Reject, Undecided };
+
+  enum class StreamMatch { Exact, Prefix, AccessControl };
+
+  struct Verdict {
+    Decision decision;
+    int reject_code;
+  };
+
+  void SetMaxConnections(int max_connections) { this->max_connections = max_connections; }
+
+  void AddAllowedPeer(const std::string& cidr);
+  void AddDeniedPeer(const std::string& cidr);
+
+  // For `StreamMatch::AccessControl` the pattern is a list of `key=value` pairs separated by commas,
+  // all of them need to be present in the stream id following the SRT access control syntax (`#!::key=value,...`)
+  void AddStreamRule(StreamMatch match, const std::string& pattern, bool accept);
+
+  Verdict Evaluate(const struct sockaddr* peer, const std::string& stream_id, int active_connections) const;
+
+private:
+  struct Network {
+    int family;
+    unsigned char address[16];
+    int prefix_len;
+  };
+
+  struct StreamRule {
+    StreamMatch match;
+    std::string pattern;
+    std::map<std::string, std::string> keys;
+    bool accept;
+  };
+
+  static Network ParseNetwork(const std::string& cidr);
+  static bool NetworkContains(const Network& network, const struct sockaddr* peer);
+  static bool StreamRuleMatches(const StreamRule& rule,
+                                const std::string& stream_id,
+                                const std::map<std::string, std::string>& access_control);
+  static std::map<std::string, std::string> ParseKeyValues(const std::string& list);
+
+  int max_connections = 0;
+  std::vector<Network> allowed_peers;
+  std::vector<Network> denied_peers;
+  std::vector<StreamRule> stream_rules;
+};
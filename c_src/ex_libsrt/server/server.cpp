@@ -1,5 +1,6 @@
 #include "server.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 #include <exception>
@@ -14,6 +15,9 @@ void Server::Run(const std::string& address,
   this->password = password;
   this->latency_ms = latency_ms;
 
+  // most of the options get applied only once connections come, so they are validated up front
+  socket_options.Validate();
+
   struct sockaddr_storage ss;
   socklen_t ss_len;
   int af;
@@ -41,6 +45,13 @@ void Server::Run(const std::string& address,
     throw std::runtime_error(std::string(srt_getlasterror_str()));
   }
 
+  // accepted sockets inherit the options, which have to be set before any others
+  transfer_options.Apply(srt_sock);
+
+  // accepted sockets are already bound by the time the listener callback runs,
+  // so they can only inherit these options from the listening socket
+  socket_options.ApplyPreBind(srt_sock);
+
   int yes = 1;
   int no = 0;
 
@@ -51,6 +62,7 @@ void Server::Run(const std::string& address,
   }
 
   srt_setsockflag(srt_sock, SRTO_RCVSYN, &no, sizeof yes);
+  srt_setsockflag(srt_sock, SRTO_SNDSYN, &no, sizeof no);
   srt_setsockflag(srt_sock, SRTO_STREAMID, &yes, sizeof yes);
   if (latency_ms >= 0) {
     if (srt_setsockflag(srt_sock, SRTO_LATENCY, &latency_ms, sizeof latency_ms) == SRT_ERROR) {
@@ -66,77 +78,303 @@ void Server::Run(const std::string& address,
   srt_listen_callback(srt_sock,
                       (srt_listen_callback_fn*)&Server::ListenAcceptCallback,
                       (void*)this);
-  srt_bind_sock = srt_listen(srt_sock, MAX_PENDING_CONNECTIONS);
+  srt_bind_sock = srt_listen(srt_sock, listen_backlog);
   if (srt_bind_sock == SRT_ERROR) {
     throw std::runtime_error(std::string(srt_getlasterror_str()));
   }
 
-  epoll = srt_epoll_create();
-  if (epoll == SRT_ERROR) {
+  listener_epoll = srt_epoll_create();
+  if (listener_epoll == SRT_ERROR) {
     throw std::runtime_error(std::string(srt_getlasterror_str()));
   }
 
   const int read_modes = SRT_EPOLL_IN | SRT_EPOLL_ERR;
-  srt_epoll_add_usock(epoll, srt_sock, &read_modes);
+  srt_epoll_add_usock(listener_epoll, srt_sock, &read_modes);
+
+  listener_mailbox = std::make_unique<CommandMailbox>();
+  listener_mailbox->Watch(listener_epoll);
+
+  for (int i = 0; i < std::max(workers_count, 1); i++) {
+    auto worker = std::make_unique<Worker>();
+
+    worker->epoll = srt_epoll_create();
+    if (worker->epoll == SRT_ERROR) {
+      throw std::runtime_error(std::string(srt_getlasterror_str()));
+    }
+
+    worker->batch_packets.reserve(static_cast<size_t>(batch_max_packets));
+
+    workers.push_back(std::move(worker));
+  }
 
   running.store(true);
 
-  epoll_loop = std::thread(&Server::RunEpoll, this);
+  for (auto& worker : workers) {
+    worker->thread = std::thread(&Server::RunWorker, this, std::ref(*worker));
+  }
+
+  listener_loop = std::thread(&Server::RunListener, this);
 }
 
 std::unique_ptr<SrtSocketStats> Server::ReadSocketStats(int socket, bool clear_intervals) {
-  if (active_sockets.find(socket) != std::end(active_sockets)) {
-    return readSrtSocketStats(socket, clear_intervals);
+  {
+    std::lock_guard<std::mutex> lock(active_sockets_mutex);
+
+    if (active_sockets.find(socket) == std::end(active_sockets)) {
+      return nullptr;
+    }
+  }
+
+  return readSrtSocketStats(socket, clear_intervals);
+}
+
+std::unique_ptr<TsStats> Server::ReadTsStats(int socket) {
+  auto connection = FindConnection(socket);
+
+  if (!connection || !connection->ts_inspector) {
+    return nullptr;
   }
 
-  return nullptr;
+  return std::make_unique<TsStats>(connection->ts_inspector->ReadStats());
+}
+
+std::unique_ptr<LatencyHistogramCounts> Server::ReadLatencyHistograms(int socket) {
+  auto connection = FindConnection(socket);
+
+  if (!connection) {
+    return nullptr;
+  }
+
+  return connection->latency_histograms.Read();
+}
+
+std::unique_ptr<SrtAggregateStats> Server::ReadAggregateStats() {
+  // the stats get read outside of the lock, so that the workers are not held off meanwhile
+  return readSrtAggregateStats(ActiveSockets());
+}
+
+std::vector<Server::SrtSocket> Server::ActiveSockets() {
+  std::lock_guard<std::mutex> lock(active_sockets_mutex);
+
+  std::vector<SrtSocket> sockets;
+  sockets.reserve(active_sockets.size());
+
+  for (const auto& entry : active_sockets) {
+    sockets.push_back(entry.first);
+  }
+
+  return sockets;
+}
+
+void Server::SetReceiveBatching(int max_packets, int max_bytes, int max_time_us) {
+  batch_max_packets = std::max(max_packets, 0);
+  batch_max_bytes = std::max(max_bytes, TransferOptions::LIVE_RECEIVE_SIZE);
+  batch_max_time_us = max_time_us;
+}
+
+void Server::EnableTsInspection(const std::vector<int>& allowed_pids) {
+  // the inspectors get created along with the connections, so the PIDs are validated up front
+  TsInspector validated(allowed_pids);
+
+  ts_inspection = true;
+  ts_allowed_pids = allowed_pids;
+}
+
+void Server::SetAdmissionRules(std::shared_ptr<const AdmissionRules> rules) {
+  std::lock_guard<std::mutex> lock(admission_rules_mutex);
+
+  admission_rules = std::move(rules);
 }
 
 void Server::Stop() {
   if (running.load()) {
     running.store(false);
-    epoll_loop.join();
+
+    // wakes the listener up instead of waiting for its epoll timeout,
+    // the workers wait in short slices anyway
+    listener_mailbox->Post([] {});
+
+    listener_loop.join();
+
+    for (auto& worker : workers) {
+      worker->thread.join();
+
+      // commands posted until the worker stopped still get executed
+      worker->mailbox.Drain();
+    }
   }
 
-  srt_epoll_release(epoll);
+  for (auto& worker : workers) {
+    srt_epoll_release(worker->epoll);
+  }
+  workers.clear();
+
+  srt_epoll_release(listener_epoll);
   srt_close(srt_sock);
 }
 
 void Server::CloseConnection(int connection_id) {
-  if (auto connection = active_sockets.find(connection_id); connection != std::end(active_sockets)) {
-    srt_epoll_remove_usock(epoll, connection_id);
-    srt_close(connection_id);
+  auto socket = (SrtSocket)connection_id;
+
+  if (!running.load()) {
+    DisconnectSocket(socket);
+
+    return;
+  }
 
-    active_sockets.erase(connection_id);
-    this->on_socket_disconnected((SrtSocket)connection_id);
+  auto connection = FindConnection(socket);
+  if (!connection) {
+    return;
   }
+
+  // the socket is removed from the epoll by the thread waiting on it, so closing never races with
+  // the handling of the socket's events
+  connection->worker->mailbox.Post([this, socket] { DisconnectSocket(socket); });
 }
 
-void Server::RunEpoll() {
-  // Setting this one prevents spamming with "no sockets to check, this would deadlock" logs during closing
-  // of the system, when there are no sockets in the epoll anymore
-  srt_epoll_set(epoll, SRT_EPOLL_ENABLE_EMPTY);
+std::vector<Server::SrtSocket> Server::Send(const std::vector<SrtSocket>& connection_ids,
+                                            OutgoingPayload payload) {
+  std::vector<SrtSocket> failed;
+
+  for (auto socket : connection_ids) {
+    auto connection = FindConnection(socket);
+
+    if (!connection) {
+      failed.push_back(socket);
+
+      continue;
+    }
+
+    std::lock_guard<std::mutex> lock(connection->send_mutex);
+
+    if (connection->closed || (int)connection->send_queue.size() >= send_queue_capacity) {
+      failed.push_back(socket);
+
+      continue;
+    }
+
+    connection->send_queue.push_back(payload);
+
+    if (!connection->writable_subscribed) {
+      SubscribeSocket(*connection, socket, true);
+    }
+  }
+
+  return failed;
+}
+
+void Server::AddRelayRoute(const std::string& stream_id, std::shared_ptr<RelayTarget> target) {
+  std::lock_guard<std::mutex> lock(relay_routes_mutex);
+
+  auto targets = std::make_shared<RelayTargets>();
+
+  auto route = relay_routes.find(stream_id);
+  if (route != std::end(relay_routes)) {
+    *targets = *route->second;
+  }
+
+  if (std::find(std::begin(*targets), std::end(*targets), target) == std::end(*targets)) {
+    targets->push_back(std::move(target));
+  }
+
+  UpdateRelayRoute(stream_id, std::move(targets));
+}
+
+void Server::RemoveRelayRoute(const std::string& stream_id, const RelayTarget* target) {
+  std::lock_guard<std::mutex> lock(relay_routes_mutex);
+
+  auto route = relay_routes.find(stream_id);
+  if (route == std::end(relay_routes)) {
+    return;
+  }
 
-  int sockets_len = 100;
-  std::vector<SrtSocket> sockets(static_cast<size_t>(sockets_len));
+  auto targets = std::make_shared<RelayTargets>(*route->second);
+  targets->erase(std::remove_if(std::begin(*targets),
+                                std::end(*targets),
+                                [&](const auto& t) { return t.get() == target; }),
+                 std::end(*targets));
 
-  int broken_sockets_len = 100;
-  std::vector<SrtSocket> broken_sockets(static_cast<size_t>(broken_sockets_len));
+  UpdateRelayRoute(stream_id, targets->empty() ? nullptr : std::move(targets));
+}
+
+// has to be called with the relay routes mutex held
+void Server::UpdateRelayRoute(const std::string& stream_id,
+                              std::shared_ptr<const RelayTargets> targets) {
+  if (targets) {
+    relay_routes[stream_id] = targets;
+  } else {
+    relay_routes.erase(stream_id);
+  }
+
+  std::lock_guard<std::mutex> lock(active_sockets_mutex);
+
+  for (auto& [socket, connection] : active_sockets) {
+    if (connection->stream_id == stream_id) {
+      std::atomic_store(&connection->relay_targets, targets);
+    }
+  }
+}
+
+std::shared_ptr<Server::Connection> Server::FindConnection(Server::SrtSocket socket) {
+  std::lock_guard<std::mutex> lock(active_sockets_mutex);
+
+  auto it = active_sockets.find(socket);
+  if (it == std::end(active_sockets)) {
+    return nullptr;
+  }
+
+  return it->second;
+}
+
+std::shared_ptr<Server::Connection> Server::FindWorkerConnection(Server::Worker& worker,
+                                                                 Server::SrtSocket socket) {
+  // only a fraction of the lookups gets timed, so that the metric adds no clock reads to most events
+  bool timed = worker.lookups++ % NativeMetrics::TIMING_INTERVAL == 0;
+  std::chrono::steady_clock::time_point start;
+  if (timed) {
+    start = std::chrono::steady_clock::now();
+  }
+
+  std::shared_ptr<Connection> connection;
+  {
+    std::lock_guard<std::mutex> lock(worker.sockets_mutex);
+
+    auto it = worker.sockets.find(socket);
+    if (it != std::end(worker.sockets)) {
+      connection = it->second;
+    }
+  }
+
+  if (timed) {
+    NativeMetrics::Global().connection_lookup_us.Record(NativeMetrics::MicrosSince(start));
+  }
+
+  return connection;
+}
+
+// has to be called with the connection's send mutex held
+void Server::SubscribeSocket(Server::Connection& connection, Server::SrtSocket socket, bool writable) {
+  // edge-triggered, so the worker has to drain the socket on each event, see `RunWorker`
+  int modes = SRT_EPOLL_IN | SRT_EPOLL_ERR | SRT_EPOLL_ET;
+  if (writable) {
+    modes |= SRT_EPOLL_OUT;
+  }
+
+  srt_epoll_update_usock(connection.worker->epoll, socket, &modes);
+  connection.writable_subscribed = writable;
+}
+
+void Server::RunListener() {
+  srt_epoll_set(listener_epoll, SRT_EPOLL_ENABLE_EMPTY);
 
   while (running.load()) {
-    sockets_len = 100;
-    broken_sockets_len = 100;
-
-    int n = srt_epoll_wait(epoll,
-                           sockets.data(),
-                           &sockets_len,
-                           broken_sockets.data(),
-                           &broken_sockets_len,
-                           1000,
-                           0,
-                           0,
-                           0,
-                           0);
+    int sockets_len = 1;
+    SrtSocket socket;
+    int wakeups_len = 1;
+    SYSSOCKET wakeup;
+
+    int n = srt_epoll_wait(
+        listener_epoll, &socket, &sockets_len, nullptr, nullptr, 1000, &wakeup, &wakeups_len, 0, 0);
 
     if (n < 1) {
       // clear out the time out error
@@ -145,34 +383,132 @@ void Server::RunEpoll() {
       continue;
     }
 
-    for (int i = 0; i < sockets_len; i++) {
-      auto socket_state = srt_getsockstate(sockets[i]);
+    if (wakeups_len > 0) {
+      listener_mailbox->Drain();
+    }
 
-      if (socket_state == SRTS_LISTENING) {
-        AcceptConnection();
-      } else if (socket_state == SRTS_BROKEN || socket_state == SRTS_CLOSED) {
-        DisconnectSocket(sockets[i]);
-      } else if (socket_state == SRTS_CONNECTED) {
-        ReadSocketData(sockets[i]);
-      } else {
-        printf("[WARNING] Encountered new socket state, report it to maintainers -> %d\n", socket_state);
-      }
+    if (sockets_len > 0 && srt_getsockstate(socket) == SRTS_LISTENING) {
+      AcceptConnection();
     }
+  }
+}
+
+void Server::RunWorker(Server::Worker& worker) {
+  // Setting this one prevents spamming with "no sockets to check, this would deadlock" logs during closing
+  // of the system, when there are no sockets in the epoll anymore
+  srt_epoll_set(worker.epoll, SRT_EPOLL_ENABLE_EMPTY);
+
+  std::vector<SRT_EPOLL_EVENT> events(static_cast<size_t>(MIN_EPOLL_EVENTS));
+
+  // sockets left with data after reaching the read limits, no further event is coming for them
+  // so they get read again on the next round
+  std::vector<SrtSocket> unread_sockets;
+  std::vector<SrtSocket> still_unread_sockets;
 
-    for (int i = 0; i < broken_sockets_len; i++) {
-      bool disconnect = true;
-      for (int j = 0; j < sockets_len; j++) {
-        if (broken_sockets[i] == sockets[j]) {
-          disconnect = false;
-          break;
+  while (running.load()) {
+    // make sure that all the worker's sockets can get reported by a single wait
+    auto events_len = static_cast<size_t>(std::max(MIN_EPOLL_EVENTS, worker.connections.load()));
+    if (events.size() < events_len) {
+      events.resize(events_len);
+    }
+
+    // srt_epoll_uwait can't watch the mailbox's pipe, but libsrt checks the sockets of its epolls
+    // in 10 ms steps anyway, so waiting in slices that long costs hardly any extra wakeups
+    int64_t timeout_ms = unread_sockets.empty() ? MAILBOX_CHECK_INTERVAL_MS : 0;
+
+    int n = srt_epoll_uwait(worker.epoll, events.data(), (int)events.size(), timeout_ms);
+
+    if (n < 0) {
+      srt_clearlasterror();
+      n = 0;
+    }
+
+    // the returned number counts all the ready sockets, even the ones that did not fit
+    n = std::min(n, (int)events.size());
+
+    auto received_before = worker.received_packets;
+    still_unread_sockets.clear();
+
+    for (auto socket : unread_sockets) {
+      if (auto connection = FindWorkerConnection(worker, socket)) {
+        if (!ReadSocketData(worker, *connection, socket)) {
+          still_unread_sockets.push_back(socket);
         }
       }
+    }
 
-      if (disconnect) {
-        DisconnectSocket(broken_sockets[i]);
+    for (int i = 0; i < n; i++) {
+      auto socket = events[i].fd;
+      auto flags = events[i].events;
+
+      // the connection is resolved once per event, the packets read for it need no further lookups
+      auto connection = FindWorkerConnection(worker, socket);
+      if (!connection) {
+        // it has been disconnected in the meantime
+        continue;
       }
+
+      // libsrt reports broken sockets with all the flags set
+      if (flags & SRT_EPOLL_ERR) {
+        DisconnectSocket(socket);
+
+        continue;
+      }
+
+      if ((flags & SRT_EPOLL_IN) && !ReadSocketData(worker, *connection, socket)) {
+        still_unread_sockets.push_back(socket);
+      }
+
+      if (flags & SRT_EPOLL_OUT) {
+        SendSocketData(*connection, socket);
+      }
+
+      // SRT_EPOLL_UPDATE concerns listeners and groups only, which never get into the workers' epolls
+    }
+
+    // a socket with both an event and leftovers from the previous round gets listed twice
+    std::sort(std::begin(still_unread_sockets), std::end(still_unread_sockets));
+    still_unread_sockets.erase(
+        std::unique(std::begin(still_unread_sockets), std::end(still_unread_sockets)),
+        std::end(still_unread_sockets));
+    std::swap(unread_sockets, still_unread_sockets);
+
+    if (worker.mailbox.Pending()) {
+      worker.mailbox.Drain();
     }
+
+    // sampled on a timer rather than on the sockets' events, so that stalled connections get sampled too
+    auto now = std::chrono::steady_clock::now();
+    if (now >= worker.next_histograms_sample_at) {
+      worker.next_histograms_sample_at = now + LatencyHistograms::SAMPLE_INTERVAL;
+
+      SampleLatencyHistograms(worker, now);
+    }
+
+    if (n > 0 || worker.received_packets > received_before) {
+      auto& metrics = NativeMetrics::Global();
+      metrics.epoll_wakeups.fetch_add(1, std::memory_order_relaxed);
+      metrics.packets_per_wakeup.Record(worker.received_packets - received_before);
+    }
+  }
+}
+
+void Server::SampleLatencyHistograms(Server::Worker& worker,
+                                     std::chrono::steady_clock::time_point now) {
+  auto& sampled = worker.sampled_connections;
+
+  {
+    std::lock_guard<std::mutex> lock(worker.sockets_mutex);
+
+    sampled.assign(std::begin(worker.sockets), std::end(worker.sockets));
+  }
+
+  // the stats get read outside of the lock, as libsrt takes its own locks for that
+  for (const auto& [socket, connection] : sampled) {
+    connection->latency_histograms.Sample(socket, now);
   }
+
+  sampled.clear();
 }
 
 int Server::ListenAcceptCallback(void* opaque,
@@ -214,37 +550,117 @@ int Server::OnNewConnection(SRTSOCKET ns,
     srt_setsockflag(ns, SRTO_LATENCY, &latency_ms, sizeof latency_ms);
   }
 
+  std::shared_ptr<const AdmissionRules> rules;
+  {
+    std::lock_guard<std::mutex> rules_lock(admission_rules_mutex);
+    rules = admission_rules;
+  }
+
+  if (rules) {
+    int active_connections;
+    {
+      std::lock_guard<std::mutex> sockets_lock(active_sockets_mutex);
+      active_connections = (int)active_sockets.size();
+    }
+
+    auto verdict = rules->Evaluate(peeraddr, streamid, active_connections);
+
+    if (verdict.decision == AdmissionRules::Decision::Reject) {
+      srt_setrejectreason(ns, verdict.reject_code);
+
+      return -1;
+    } else if (verdict.decision == AdmissionRules::Decision::Accept) {
+      if (!ApplySocketOptions(ns, socket_options)) {
+        return -1;
+      }
+
+      auto context = this->on_connect_request_admitted(ns, address, streamid);
+
+      std::lock_guard<std::mutex> lock(accept_mutex);
+      pending_contexts[ns] = std::move(context);
+
+      return 0;
+    }
+  }
+
   std::unique_lock<std::mutex> lock(accept_mutex);
 
-  awaiting_connect_request_socket = ns;
+  connect_request.emplace(ConnectRequest{ns});
+
+  this->on_connect_request(ns, address, streamid);
 
-  this->on_connect_request(address, streamid);
+  // NOTE: this check should be very fast as libsrt invokes the callback synchronously,
+  // blocking any receiving on the listener, including other handshakes, until the request gets answered
+  bool answered = accept_cv.wait_for(lock,
+                                     std::chrono::milliseconds(connect_request_timeout_ms),
+                                     [&] { return connect_request->answered; });
+  bool accepted = connect_request->accepted;
+  auto context = std::move(connect_request->context);
+  auto options = socket_options.OverriddenBy(connect_request->socket_options);
 
-  // NOTE: this check should be very fast as it blocks any receiving on the socket
-  auto result = accept_cv.wait_for(lock, std::chrono::milliseconds(1000));
+  connect_request.reset();
 
-  if (result == std::cv_status::timeout) {
+  if (!answered) {
     srt_setrejectreason(ns, SRT_REJC_PREDEFINED + 504);
 
     return -1;
-  } else if (!accept_awaiting_stream_id) {
+  } else if (!accepted) {
     srt_setrejectreason(ns, SRT_REJC_PREDEFINED + 403);
 
     return -1;
   }
 
+  if (!ApplySocketOptions(ns, options)) {
+    return -1;
+  }
+
+  pending_contexts[ns] = std::move(context);
+
   return 0;
 }
 
-void Server::AnswerConnectRequest(int accept) {
+// a socket that can't get its options gets rejected, as it would not perform as configured
+bool Server::ApplySocketOptions(SRTSOCKET ns, const SocketOptions& options) {
+  try {
+    // the pre-bind options have already been inherited from the listening socket
+    options.ApplyPostBind(ns);
+
+    return true;
+  } catch (const std::exception&) {
+    srt_setrejectreason(ns, SRT_REJC_PREDEFINED + 500);
+
+    return false;
+  }
+}
+
+Server::SrtSocket Server::AnswerConnectRequest(Server::SrtSocket request_id,
+                                              bool accept,
+                                              std::shared_ptr<ConnectionContext> context,
+                                              const SocketOptions& overrides) {
+  // checked here, so that the listener callback can't fail on the overrides
+  socket_options.OverriddenBy(overrides).Validate();
+
+  SrtSocket answered_id = -1;
+
   {
     std::lock_guard<std::mutex> lock(accept_mutex);
 
-    accept_awaiting_stream_id = accept;
-    awaiting_connect_request_socket = -1;
+    if (connect_request && !connect_request->answered &&
+        (request_id < 0 || connect_request->socket == request_id)) {
+      connect_request->answered = true;
+      connect_request->accepted = accept;
+      connect_request->context = accept ? std::move(context) : nullptr;
+      connect_request->socket_options = overrides;
+
+      answered_id = connect_request->socket;
+    }
+  }
+
+  if (answered_id != -1) {
+    accept_cv.notify_all();
   }
 
-  accept_cv.notify_one();
+  return answered_id;
 }
 
 bool Server::IsListeningSocket(Server::SrtSocket socket) const {
@@ -260,23 +676,303 @@ bool Server::IsSocketClosed(Server::SrtSocket socket) const {
 }
 
 void Server::DisconnectSocket(Server::SrtSocket socket) {
-  srt_epoll_remove_usock(epoll, socket);
+  std::shared_ptr<Connection> connection;
+
+  {
+    std::lock_guard<std::mutex> lock(active_sockets_mutex);
+
+    // the socket may be closed concurrently by the user and by its worker
+    auto it = active_sockets.find(socket);
+    if (it == std::end(active_sockets)) {
+      return;
+    }
+
+    connection = std::move(it->second);
+    connection->worker->connections--;
+
+    active_sockets.erase(it);
+
+    std::lock_guard<std::mutex> worker_lock(connection->worker->sockets_mutex);
+    connection->worker->sockets.erase(socket);
+  }
+
+  {
+    // prevents concurrent senders from subscribing the socket again
+    std::lock_guard<std::mutex> lock(connection->send_mutex);
+
+    connection->closed = true;
+    connection->send_queue.clear();
+  }
+
+  srt_epoll_remove_usock(connection->worker->epoll, socket);
   srt_close(socket);
 
-  active_sockets.erase(socket);
-  this->on_socket_disconnected(socket);
+  this->on_socket_disconnected(socket, connection->context.get());
 }
 
-void Server::ReadSocketData(Server::SrtSocket socket) {
-  char buffer[1500];
+bool Server::ReadSocketData(Server::Worker& worker,
+                            Server::Connection& connection,
+                            Server::SrtSocket socket) {
+  if (auto targets = std::atomic_load(&connection.relay_targets)) {
+    return RelaySocketData(worker, socket, *targets);
+  }
+
+  if (batch_max_packets > 0) {
+    return ReadSocketDataBatch(worker, connection, socket);
+  }
+
+  int receive_size = transfer_options.ReceiveSize();
+  // otherwise a region of the maximum message size would get reserved for every message
+  bool in_place = receive_size <= transfer_options.DirectReceiveSize();
+
+  for (int i = 0; i < MAX_PACKETS_PER_READ; i++) {
+    char* buffer = in_place ? ReserveReceiveBuffer(worker, receive_size)
+                            : ReserveScratchBuffer(worker, receive_size);
+
+    int n = srt_recv(socket, buffer, receive_size);
+
+    if (n == SRT_ERROR && srt_getlasterror(nullptr) == SRT_EASYNCRCV) {
+      // the socket has been drained, clear out the would-block error
+      srt_clearlasterror();
+
+      return true;
+    } else if (n == 0 || n == SRT_ERROR) {
+      DisconnectSocket(socket);
+
+      return true;
+    }
+
+    // only a fraction of the callbacks gets timed, so that the metric adds no clock reads to most packets
+    bool timed = worker.received_packets++ % NativeMetrics::TIMING_INTERVAL == 0;
+
+    if (connection.ts_inspector) {
+      n = static_cast<int>(connection.ts_inspector->Inspect(buffer, static_cast<size_t>(n)));
+
+      // none of the packets got through the filter
+      if (n == 0) {
+        continue;
+      }
+    }
+
+    if (!in_place) {
+      char* data = ReserveReceiveBuffer(worker, n);
+      memcpy(data, buffer, n);
+      buffer = data;
+    }
+
+    if (!timed) {
+      this->on_socket_data(socket, connection.context.get(), buffer, n);
+
+      continue;
+    }
+
+    auto callback_start = std::chrono::steady_clock::now();
+    this->on_socket_data(socket, connection.context.get(), buffer, n);
+    NativeMetrics::Global().data_callback_us.Record(NativeMetrics::MicrosSince(callback_start));
+  }
+
+  return false;
+}
+
+bool Server::ReadSocketDataBatch(Server::Worker& worker,
+                                 Server::Connection& connection,
+                                 Server::SrtSocket socket) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(batch_max_time_us);
+
+  auto& batch_packets = worker.batch_packets;
+  batch_packets.clear();
+
+  int receive_size = transfer_options.ReceiveSize();
+
+  // The region has room for one more message in place as long as the byte limit has not been reached,
+  // so a whole drain ends up in a single contiguous buffer.
+  int region_size = batch_max_bytes + transfer_options.DirectReceiveSize();
+  char* region = ReserveReceiveBuffer(worker, static_cast<size_t>(region_size));
+
+  int offset = 0;
+  int reads = 0;
+  bool drained = false;
+  bool disconnected = false;
+  // a message that did not fit the rest of the region, left in the scratch buffer
+  std::string_view oversized;
+
+  // bounded by the reads rather than by the delivered packets, which may get filtered out entirely
+  while (reads < batch_max_packets && offset < batch_max_bytes) {
+    // a message that may not fit the rest of the region gets received into the scratch buffer
+    bool in_place = receive_size <= region_size - offset;
+    char* buffer = in_place ? region + offset : ReserveScratchBuffer(worker, receive_size);
+
+    int n = srt_recv(socket, buffer, receive_size);
+
+    if (n == SRT_ERROR && srt_getlasterror(nullptr) == SRT_EASYNCRCV) {
+      // the socket has been drained, clear out the would-block error
+      srt_clearlasterror();
+      drained = true;
+
+      break;
+    } else if (n == 0 || n == SRT_ERROR) {
+      disconnected = true;
+
+      break;
+    }
+
+    reads++;
+
+    if (connection.ts_inspector) {
+      n = static_cast<int>(connection.ts_inspector->Inspect(buffer, static_cast<size_t>(n)));
+    }
+
+    if (n > region_size - offset) {
+      oversized = std::string_view(buffer, n);
+
+      break;
+    }
+
+    if (n > 0) {
+      if (!in_place) {
+        memcpy(region + offset, buffer, n);
+        buffer = region + offset;
+      }
+
+      batch_packets.emplace_back(buffer, n);
+      offset += n;
+    }
+
+    if (batch_max_time_us > 0 && std::chrono::steady_clock::now() >= deadline) {
+      break;
+    }
+  }
+
+  worker.received_packets += reads;
 
-  int n = srt_recv(socket, buffer, sizeof(buffer));
+  if (!batch_packets.empty()) {
+    auto callback_start = std::chrono::steady_clock::now();
+    this->on_socket_data_batch(socket, connection.context.get(), batch_packets);
+    NativeMetrics::Global().data_callback_us.Record(NativeMetrics::MicrosSince(callback_start));
+  }
+
+  if (!oversized.empty()) {
+    // reserved only once the batch has been delivered, as the reservation may replace the region
+    char* data = ReserveReceiveBuffer(worker, oversized.size());
+    memcpy(data, oversized.data(), oversized.size());
+
+    batch_packets.clear();
+    batch_packets.emplace_back(data, oversized.size());
+
+    auto callback_start = std::chrono::steady_clock::now();
+    this->on_socket_data_batch(socket, connection.context.get(), batch_packets);
+    NativeMetrics::Global().data_callback_us.Record(NativeMetrics::MicrosSince(callback_start));
+  }
 
-  if (n == 0 || n == SRT_ERROR) {
+  if (disconnected) {
     DisconnectSocket(socket);
-  } else {
-    this->on_socket_data(socket, buffer, n);
   }
+
+  return drained || disconnected;
+}
+
+void Server::SendSocketData(Server::Connection& connection, Server::SrtSocket socket) {
+  std::lock_guard<std::mutex> lock(connection.send_mutex);
+
+  if (connection.closed) {
+    return;
+  }
+
+  auto& send_queue = connection.send_queue;
+
+  while (!send_queue.empty()) {
+    const auto& payload = *send_queue.front();
+
+    int result;
+    if (transfer_options.message_api) {
+      result = srt_sendmsg(socket, payload.data(), (int)payload.size(), -1, 0);
+    } else {
+      // a byte stream may get accepted in parts
+      result = srt_send(socket,
+                        payload.data() + connection.send_offset,
+                        (int)(payload.size() - connection.send_offset));
+    }
+
+    if (result == SRT_ERROR) {
+      if (srt_getlasterror(nullptr) == SRT_EASYNCSND) {
+        // the sender buffer is full, the rest gets sent on the next writable event
+        srt_clearlasterror();
+
+        return;
+      }
+
+      // a broken socket gets disconnected on its error event
+      send_queue.clear();
+      break;
+    }
+
+    if (!transfer_options.message_api) {
+      connection.send_offset += result;
+
+      if (connection.send_offset < payload.size()) {
+        continue;
+      }
+
+      connection.send_offset = 0;
+    }
+
+    send_queue.pop_front();
+  }
+
+  SubscribeSocket(connection, socket, false);
+}
+
+bool Server::RelaySocketData(Server::Worker& worker,
+                             Server::SrtSocket socket,
+                             const Server::RelayTargets& targets) {
+  int receive_size = transfer_options.ReceiveSize();
+
+  // relayed data never reaches the BEAM, so it can always be received into the scratch buffer
+  char* buffer = ReserveScratchBuffer(worker, receive_size);
+
+  // bounded just like the reads of the data callbacks, so that a single relayed connection
+  // can't starve the other sockets of the worker
+  for (int i = 0; i < MAX_PACKETS_PER_READ; i++) {
+    int n = srt_recv(socket, buffer, receive_size);
+
+    if (n == SRT_ERROR && srt_getlasterror(nullptr) == SRT_EASYNCRCV) {
+      srt_clearlasterror();
+
+      return true;
+    } else if (n == 0 || n == SRT_ERROR) {
+      DisconnectSocket(socket);
+
+      return true;
+    }
+
+    worker.received_packets++;
+
+    for (const auto& target : targets) {
+      target->Forward(buffer, n);
+    }
+  }
+
+  return false;
+}
+
+char* Server::ReserveReceiveBuffer(Server::Worker& worker, size_t size) {
+  if (receive_buffer_provider) {
+    return receive_buffer_provider(size);
+  }
+
+  if (worker.receive_buffer.size() < size) {
+    worker.receive_buffer.resize(size);
+  }
+
+  return worker.receive_buffer.data();
+}
+
+char* Server::ReserveScratchBuffer(Server::Worker& worker, size_t size) {
+  if (worker.scratch_buffer.size() < size) {
+    worker.scratch_buffer.resize(size);
+  }
+
+  return worker.scratch_buffer.data();
 }
 
 void Server::AcceptConnection() {
@@ -294,9 +990,58 @@ void Server::AcceptConnection() {
 
   auto streamid = std::string(raw_streamid, raw_streamid + max_streamid_len);
 
-  this->on_socket_connected(socket, streamid);
-  active_sockets.insert(socket);
+  std::shared_ptr<ConnectionContext> context;
 
-  const int read_modes = SRT_EPOLL_IN | SRT_EPOLL_ERR;
-  srt_epoll_add_usock(epoll, socket, &read_modes);
+  {
+    std::lock_guard<std::mutex> lock(accept_mutex);
+
+    auto pending = pending_contexts.find(socket);
+    if (pending != std::end(pending_contexts)) {
+      context = std::move(pending->second);
+      pending_contexts.erase(pending);
+    }
+  }
+
+  std::shared_ptr<Connection> connection;
+
+  {
+    std::lock_guard<std::mutex> routes_lock(relay_routes_mutex);
+    std::lock_guard<std::mutex> lock(active_sockets_mutex);
+
+    auto& worker = LeastLoadedWorker();
+    worker.connections++;
+
+    connection = std::make_shared<Connection>(&worker, streamid, context);
+
+    if (ts_inspection) {
+      connection->ts_inspector = std::make_unique<TsInspector>(ts_allowed_pids);
+    }
+
+    auto route = relay_routes.find(streamid);
+    if (route != std::end(relay_routes)) {
+      connection->relay_targets = route->second;
+    }
+
+    active_sockets.emplace(socket, connection);
+
+    std::lock_guard<std::mutex> worker_lock(worker.sockets_mutex);
+    worker.sockets.emplace(socket, connection);
+  }
+
+  this->on_socket_connected(socket, context.get(), streamid);
+
+  // data may have already been enqueued for the connection from within the callback
+  std::lock_guard<std::mutex> lock(connection->send_mutex);
+
+  if (!connection->closed) {
+    SubscribeSocket(*connection, socket, !connection->send_queue.empty());
+  }
+}
+
+Server::Worker& Server::LeastLoadedWorker() {
+  auto it = std::min_element(std::begin(workers), std::end(workers), [](const auto& a, const auto& b) {
+    return a->connections.load() < b->connections.load();
+  });
+
+  return **it;
 }
@@ -1,29 +1,64 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <srt/srt.h>
 #include <string>
+#include <string_view>
 #include <thread>
-#include <set>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../common/command_mailbox.h"
+#include "../common/latency_histograms.h"
+#include "../common/native_metrics.h"
+#include "../common/relay_target.h"
+#include "../common/socket_options.h"
 #include "../common/srt_socket_stats.h"
+#include "../common/transfer_options.h"
+#include "admission_rules.h"
+#include "ts_inspector.h"
 
 extern "C" {
 #include <arpa/inet.h>
 }
 
 class Server {
-  static const int MAX_PENDING_CONNECTIONS = 5;
+  static const int DEFAULT_LISTEN_BACKLOG = 5;
+  static const int DEFAULT_CONNECT_REQUEST_TIMEOUT_MS = 1000;
+  static constexpr int MIN_EPOLL_EVENTS = 100;
+  // packets read or relayed from a socket per event when not batching, the rest is read on the next round
+  static constexpr int MAX_PACKETS_PER_READ = 64;
+  // srt_epoll_uwait can't be woken up by the mailbox, so this bounds the delay of the control
+  // operations posted to a worker, such as closing a connection or stopping the server
+  static constexpr int64_t MAILBOX_CHECK_INTERVAL_MS = 10;
+  static const int DEFAULT_SEND_QUEUE_CAPACITY = 256;
 
 public:
   using SrtSocket = int;
   using SrtEpoll = int;
 
-  Server() = default;
+  // Data to be sent, shared by all the connections it gets enqueued for.
+  // The owner keeps the referenced memory alive until the last reference is gone.
+  using OutgoingPayload = std::shared_ptr<const std::string_view>;
+
+  using RelayTargets = std::vector<std::shared_ptr<RelayTarget>>;
+
+  // Data attached to a connection by the server's user when accepting it, handed to every
+  // callback of the connection so that they don't need to look it up by the socket
+  struct ConnectionContext {
+    virtual ~ConnectionContext() = default;
+  };
+
+  // Accepted connections are spread across `workers_count` epoll threads
+  explicit Server(int workers_count = 1) : workers_count(workers_count) {}
   ~Server() = default;
 
   void Run(const std::string& address,
@@ -33,51 +68,195 @@ public:
 
   void Stop();
 
+  // Drains readable sockets until they would block or a limit is reached,
+  // non-positive `max_packets` disables batching, `max_time_us` of 0 means no time budget
+  void SetReceiveBatching(int max_packets, int max_bytes, int max_time_us);
+
+  void SetListenBacklog(int backlog) { listen_backlog = backlog; }
+
+  void SetConnectRequestTimeout(int timeout_ms) { connect_request_timeout_ms = timeout_ms; }
+
+  // Maximum number of messages waiting for being sent to a single connection
+  void SetSendQueueCapacity(int capacity) { send_queue_capacity = capacity; }
+
+  // Applies to all the accepted connections, has to be set before running the server
+  void SetTransferOptions(const TransferOptions& options) { transfer_options = options; }
+
+  // The largest message that can be sent to or received from a connection in one piece
+  int MaxMessageSize() const { return transfer_options.MaxMessageSize(); }
+
+  // Applies to every accepted socket, has to be set before running the server. The pre-bind options
+  // are set on the listening socket and get inherited, the rest are set from within the listener callback.
+  void SetSocketOptions(const SocketOptions& options) { socket_options = options; }
+
+  // Makes the workers inspect received MPEG-TS packets and deliver only the ones of the allowed PIDs,
+  // an empty list allows all of them. Has to be set before running the server.
+  void EnableTsInspection(const std::vector<int>& allowed_pids);
+
+  // Installs rules deciding about connect requests natively, only requests left undecided
+  // get passed to the connect request callback. Passing nullptr removes the rules.
+  void SetAdmissionRules(std::shared_ptr<const AdmissionRules> rules);
+
+  // Closes the connection on its worker's thread, returns before the connection gets closed,
+  // which happens within `MAILBOX_CHECK_INTERVAL_MS`
   void CloseConnection(int connection_id);
 
-  void AnswerConnectRequest(int accept);
+  // Enqueues the same payload for sending to each of the connections without copying it,
+  // returns the connections it could not be enqueued for, either unknown or with a full send queue
+  std::vector<SrtSocket> Send(const std::vector<SrtSocket>& connection_ids, OutgoingPayload payload);
+
+  // Packets received from connections with the given stream id get forwarded natively to the route's
+  // targets, skipping the data callbacks. Routes apply to both active and future connections.
+  void AddRelayRoute(const std::string& stream_id, std::shared_ptr<RelayTarget> target);
+  void RemoveRelayRoute(const std::string& stream_id, const RelayTarget* target);
 
-  SrtSocket GetAwaitingConnectionRequestId() const { return awaiting_connect_request_socket; }
+  // Answers the pending connect request, a negative `request_id` answers it whatever its id is,
+  // while a positive one that does not match it is an answer that came too late.
+  // An accepted connection gets the given context attached and the set `overrides` take precedence
+  // over the server's socket options. Throws std::runtime_error on invalid overrides, including
+  // any pre-bind option, see `SocketOptions::OverriddenBy`.
+  // Returns the id of the answered request or -1 when there is no such pending request.
+  SrtSocket AnswerConnectRequest(SrtSocket request_id,
+                                 bool accept,
+                                 std::shared_ptr<ConnectionContext> context = nullptr,
+                                 const SocketOptions& overrides = {});
 
   std::unique_ptr<SrtSocketStats> ReadSocketStats(int socket, bool clear_intervals);
 
+  // Returns nullptr for unknown connections and when the TS inspection is disabled
+  std::unique_ptr<TsStats> ReadTsStats(int socket);
+
+  // Bucket counts of the connection's rolling RTT and receive buffer delay histograms,
+  // see `RollingHistogram::BUCKET_BOUNDS`
+  std::unique_ptr<LatencyHistogramCounts> ReadLatencyHistograms(int socket);
+
+  // Totals and distributions across all the active connections
+  std::unique_ptr<SrtAggregateStats> ReadAggregateStats();
+
+  std::vector<SrtSocket> ActiveSockets();
+
+  // The connection callbacks get the context attached to the connection, which may be nullptr
+
   void SetOnSocketConnected(
-      std::function<void(SrtSocket, const std::string&)> on_socket_connected) {
+      std::function<void(SrtSocket, ConnectionContext*, const std::string&)> on_socket_connected) {
     this->on_socket_connected = std::move(on_socket_connected);
   };
 
   void SetOnSocketDisconnected(
-      std::function<void(SrtSocket)>&& on_socket_disconnected) {
+      std::function<void(SrtSocket, ConnectionContext*)>&& on_socket_disconnected) {
     this->on_socket_disconnected = std::move(on_socket_disconnected);
   }
 
   void SetOnSocketData(
-      std::function<void(SrtSocket, const char*, int)>&& on_socket_data) {
+      std::function<void(SrtSocket, ConnectionContext*, const char*, int)>&& on_socket_data) {
     this->on_socket_data = std::move(on_socket_data);
   }
 
+  // Provides memory that socket data gets received into, the data passed to the data
+  // callbacks points into the returned region of at least `size` bytes
+  void SetReceiveBufferProvider(std::function<char*(size_t)>&& receive_buffer_provider) {
+    this->receive_buffer_provider = std::move(receive_buffer_provider);
+  }
+
+  void SetOnSocketDataBatch(
+      std::function<void(SrtSocket, ConnectionContext*, const std::vector<std::string_view>&)>&&
+          on_socket_data_batch) {
+    this->on_socket_data_batch = std::move(on_socket_data_batch);
+  }
+
   void
   SetOnFatalError(std::function<void(const std::string&)>&& on_fatal_error) {
     this->on_fatal_error = std::move(on_fatal_error);
   }
 
   void SetOnConnectRequest(
-      std::function<void(const std::string&, const std::string&)>&&
+      std::function<void(SrtSocket, const std::string&, const std::string&)>&&
           on_connect_request) {
     this->on_connect_request = std::move(on_connect_request);
   }
 
+  // Returns the context to be attached to the connection admitted by the native rules
+  void SetOnConnectRequestAdmitted(
+      std::function<std::shared_ptr<ConnectionContext>(
+          SrtSocket, const std::string&, const std::string&)>&& on_connect_request_admitted) {
+    this->on_connect_request_admitted = std::move(on_connect_request_admitted);
+  }
+
 private:
   bool IsListeningSocket(SrtSocket socket) const;
   bool IsSocketBroken(SrtSocket socket) const;
   bool IsSocketClosed(SrtSocket socket) const;
 
-  void ReadSocketData(SrtSocket socket);
+  struct Connection;
+
+  struct Worker {
+    SrtEpoll epoll = -1;
+    std::thread thread;
+    std::atomic_int connections = 0;
+    // control operations executed on the worker's thread
+    CommandMailbox mailbox;
+    // the worker's own connections, so that its events are resolved without the server wide lock
+    std::mutex sockets_mutex;
+    std::unordered_map<SrtSocket, std::shared_ptr<Connection>> sockets;
+    std::vector<std::string_view> batch_packets;
+    // used when there is no receive buffer provider
+    std::vector<char> receive_buffer;
+    // data that never reaches the callbacks in place, either relayed or copied out afterwards
+    std::vector<char> scratch_buffer;
+    // packets received since the worker started, only touched by the worker's thread
+    uint64_t received_packets = 0;
+    // connection lookups since the worker started, only touched by the worker's thread
+    uint64_t lookups = 0;
+    std::chrono::steady_clock::time_point next_histograms_sample_at;
+    std::vector<std::pair<SrtSocket, std::shared_ptr<Connection>>> sampled_connections;
+  };
+
+  struct Connection {
+    Connection(Worker* worker, std::string stream_id, std::shared_ptr<ConnectionContext> context)
+        : worker(worker), stream_id(std::move(stream_id)), context(std::move(context)) {}
+
+    Worker* const worker;
+    const std::string stream_id;
+    const std::shared_ptr<ConnectionContext> context;
+
+    // replaced as a whole whenever the routes change, accessed with atomic shared_ptr operations
+    std::shared_ptr<const RelayTargets> relay_targets;
+
+    std::mutex send_mutex;
+    std::deque<OutgoingPayload> send_queue;
+    // bytes of the front payload already sent, when transferring a byte stream
+    size_t send_offset = 0;
+    // whether the socket is subscribed to writable events, which happens only while there is data to send
+    bool writable_subscribed = false;
+    bool closed = false;
+
+    // sampled by the worker periodically, whether the socket has any events or not
+    LatencyHistograms latency_histograms;
+
+    // set when accepting the connection, used by the worker only
+    std::unique_ptr<TsInspector> ts_inspector;
+  };
+
+  std::shared_ptr<Connection> FindConnection(SrtSocket socket);
+  std::shared_ptr<Connection> FindWorkerConnection(Worker& worker, SrtSocket socket);
+  void SubscribeSocket(Connection& connection, SrtSocket socket, bool writable);
+  void SampleLatencyHistograms(Worker& worker, std::chrono::steady_clock::time_point now);
+
+  // The reads return false when the socket is left with data after reaching the read limits
+  bool ReadSocketData(Worker& worker, Connection& connection, SrtSocket socket);
+  void SendSocketData(Connection& connection, SrtSocket socket);
+  bool RelaySocketData(Worker& worker, SrtSocket socket, const RelayTargets& targets);
+  void UpdateRelayRoute(const std::string& stream_id, std::shared_ptr<const RelayTargets> targets);
+  bool ReadSocketDataBatch(Worker& worker, Connection& connection, SrtSocket socket);
+  char* ReserveReceiveBuffer(Worker& worker, size_t size);
+  char* ReserveScratchBuffer(Worker& worker, size_t size);
   void DisconnectSocket(SrtSocket socket);
 
   void AcceptConnection();
+  Worker& LeastLoadedWorker();
 
-  void RunEpoll();
+  void RunListener();
+  void RunWorker(Worker& worker);
 
   static int ListenAcceptCallback(void* opaque,
                                   SRTSOCKET ns,
@@ -90,27 +269,74 @@ private:
                       const struct sockaddr* peeraddr,
                       const char* streamid);
 
+  // Sets the socket options of a new connection, rejecting it with 1500 code on failure
+  bool ApplySocketOptions(SRTSOCKET ns, const SocketOptions& options);
+
 private:
   SrtSocket srt_sock;
   SrtSocket srt_bind_sock;
   std::string password;
   int latency_ms = -1;
 
+  TransferOptions transfer_options;
+  SocketOptions socket_options;
+
+  bool ts_inspection = false;
+  std::vector<int> ts_allowed_pids;
+
+  int batch_max_packets = 0;
+  int batch_max_bytes = 0;
+  int batch_max_time_us = 0;
+  std::function<char*(size_t)> receive_buffer_provider;
+
   std::atomic_bool running;
-  SrtEpoll epoll;
-  std::thread epoll_loop;
+  SrtEpoll listener_epoll = -1;
+  std::thread listener_loop;
+  // only used for waking the listener up when stopping
+  std::unique_ptr<CommandMailbox> listener_mailbox;
+
+  const int workers_count;
+  std::vector<std::unique_ptr<Worker>> workers;
 
 private:
-  std::set<SrtSocket> active_sockets;
-  std::function<void(SrtSocket, const std::string&)> on_socket_connected;
-  std::function<void(SrtSocket)> on_socket_disconnected;
-  std::function<void(SrtSocket, const char*, int)> on_socket_data;
+  std::mutex active_sockets_mutex;
+  std::map<SrtSocket, std::shared_ptr<Connection>> active_sockets;
+  std::function<void(SrtSocket, ConnectionContext*, const std::string&)> on_socket_connected;
+  std::function<void(SrtSocket, ConnectionContext*)> on_socket_disconnected;
+  std::function<void(SrtSocket, ConnectionContext*, const char*, int)> on_socket_data;
+  std::function<void(SrtSocket, ConnectionContext*, const std::vector<std::string_view>&)>
+      on_socket_data_batch;
   std::function<void(const std::string&)> on_fatal_error;
-  std::function<void(const std::string&, const std::string&)>
+  std::function<void(SrtSocket, const std::string&, const std::string&)>
       on_connect_request;
+  std::function<std::shared_ptr<ConnectionContext>(
+      SrtSocket, const std::string&, const std::string&)>
+      on_connect_request_admitted;
+
+  // lock order: relay_routes_mutex before active_sockets_mutex before a worker's sockets_mutex
+  std::mutex relay_routes_mutex;
+  std::map<std::string, std::shared_ptr<const RelayTargets>> relay_routes;
+
+  std::mutex admission_rules_mutex;
+  std::shared_ptr<const AdmissionRules> admission_rules;
+
+  struct ConnectRequest {
+    SrtSocket socket;
+    bool answered = false;
+    bool accepted = false;
+    std::shared_ptr<ConnectionContext> context = nullptr;
+    SocketOptions socket_options = {};
+  };
+
+  int listen_backlog = DEFAULT_LISTEN_BACKLOG;
+  int connect_request_timeout_ms = DEFAULT_CONNECT_REQUEST_TIMEOUT_MS;
+  int send_queue_capacity = DEFAULT_SEND_QUEUE_CAPACITY;
 
   std::mutex accept_mutex;
   std::condition_variable accept_cv;
-  bool accept_awaiting_stream_id = false;
-  SrtSocket awaiting_connect_request_socket = -1;
+  // libsrt invokes the listener callback synchronously on its receiving thread, so there is never
+  // more than a single request waiting for being answered
+  std::optional<ConnectRequest> connect_request;
+  // contexts of admitted connections that have not been accepted yet
+  std::map<SrtSocket, std::shared_ptr<ConnectionContext>> pending_contexts;
 };
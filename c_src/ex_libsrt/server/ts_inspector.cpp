@@ -0,0 +1,119 @@
+#include "ts_inspector.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+TsInspector::TsInspector(const std::vector<int>& pids) : filtering(!pids.empty()) {
+  for (int pid : pids) {
+    if (pid < 0 || pid >= PID_COUNT) {
+      throw std::runtime_error("Invalid TS PID: " + std::to_string(pid));
+    }
+
+    allowed_pids.set(static_cast<size_t>(pid));
+  }
+
+  continuity_counters.fill(-1);
+}
+
+size_t TsInspector::Inspect(char* data, size_t size) {
+  auto bytes = reinterpret_cast<uint8_t*>(data);
+  size_t whole_size = size - size % PACKET_SIZE;
+
+  // counted locally, so that the shared counters get updated once per payload
+  uint64_t inspected = 0;
+  uint64_t kept = 0;
+  uint64_t missing_sync = size == whole_size ? 0 : 1;
+  uint64_t discontinuities = 0;
+  uint64_t pcrs = 0;
+
+  size_t kept_size = 0;
+
+  for (size_t offset = 0; offset < whole_size; offset += PACKET_SIZE) {
+    const uint8_t* packet = bytes + offset;
+    inspected++;
+
+    if (packet[0] != SYNC_BYTE) {
+      missing_sync++;
+
+      // without filtering the payload gets delivered intact, so a broken packet only gets counted
+      if (filtering) {
+        continue;
+      }
+    } else {
+      int pid = InspectPacket(packet, discontinuities, pcrs);
+
+      if (filtering && !allowed_pids.test(static_cast<size_t>(pid))) {
+        continue;
+      }
+    }
+
+    // a kept packet never overlaps with its new place, as that place is at least a packet behind
+    if (kept_size != offset) {
+      std::memcpy(bytes + kept_size, packet, PACKET_SIZE);
+    }
+
+    kept_size += PACKET_SIZE;
+    kept++;
+  }
+
+  packets.fetch_add(inspected, std::memory_order_relaxed);
+  forwarded_packets.fetch_add(kept, std::memory_order_relaxed);
+  sync_errors.fetch_add(missing_sync, std::memory_order_relaxed);
+  cc_errors.fetch_add(discontinuities, std::memory_order_relaxed);
+  pcr_count.fetch_add(pcrs, std::memory_order_relaxed);
+
+  // trailing bytes not forming a whole packet are kept as well when not filtering
+  return filtering ? kept_size : size;
+}
+
+int TsInspector::InspectPacket(const uint8_t* packet, uint64_t& discontinuities, uint64_t& pcrs) {
+  int pid = ((packet[1] & 0x1F) << 8) | packet[2];
+  bool has_adaptation_field = packet[3] & 0x20;
+  bool has_payload = packet[3] & 0x10;
+  int cc = packet[3] & 0x0F;
+
+  int adaptation_field_length = has_adaptation_field ? packet[4] : 0;
+  uint8_t adaptation_flags = adaptation_field_length > 0 ? packet[5] : 0;
+
+  // null packets carry no meaningful continuity counter
+  if (pid != NULL_PID) {
+    int last_cc = continuity_counters[pid];
+    bool discontinuity = adaptation_flags & 0x80;
+
+    // the counter advances only with a payload, a single repetition of a packet is allowed
+    if (last_cc >= 0 && !discontinuity && cc != last_cc &&
+        (!has_payload || cc != ((last_cc + 1) & 0x0F))) {
+      discontinuities++;
+    }
+
+    continuity_counters[pid] = static_cast<int8_t>(cc);
+  }
+
+  if ((adaptation_flags & 0x10) && adaptation_field_length >= 7) {
+    const uint8_t* pcr = packet + 6;
+
+    int64_t base = (int64_t(pcr[0]) << 25) | (int64_t(pcr[1]) << 17) | (int64_t(pcr[2]) << 9) |
+                   (int64_t(pcr[3]) << 1) | (pcr[4] >> 7);
+    int64_t extension = ((pcr[4] & 0x01) << 8) | pcr[5];
+
+    last_pcr.store(base * 300 + extension, std::memory_order_relaxed);
+    last_pcr_pid.store(pid, std::memory_order_relaxed);
+    pcrs++;
+  }
+
+  return pid;
+}
+
+TsStats TsInspector::ReadStats() const {
+  TsStats stats;
+  stats.packets = packets.load(std::memory_order_relaxed);
+  stats.forwarded_packets = forwarded_packets.load(std::memory_order_relaxed);
+  stats.sync_errors = sync_errors.load(std::memory_order_relaxed);
+  stats.cc_errors = cc_errors.load(std::memory_order_relaxed);
+  stats.pcr_count = pcr_count.load(std::memory_order_relaxed);
+  stats.last_pcr = last_pcr.load(std::memory_order_relaxed);
+  stats.last_pcr_pid = last_pcr_pid.load(std::memory_order_relaxed);
+
+  return stats;
+}
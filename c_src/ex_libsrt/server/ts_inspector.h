@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Health counters of a connection's MPEG-TS stream, accumulated since the connection got accepted
+struct TsStats {
+  uint64_t packets;
+  // packets left after filtering the PIDs
+  uint64_t forwarded_packets;
+  // packets without the sync byte, together with trailing bytes not forming a whole packet
+  uint64_t sync_errors;
+  uint64_t cc_errors;
+  uint64_t pcr_count;
+  // the latest PCR in 27 MHz units and the PID carrying it, both -1 before the first one
+  int64_t last_pcr;
+  int last_pcr_pid;
+};
+
+// Inspection of MPEG-TS packets carried by the received payloads, done in place before the payloads
+// get delivered. Every packet gets checked for the sync byte and for gaps in its PID's continuity
+// counter, PCRs get extracted and, when filtering, only the valid packets of the allowed PIDs are kept.
+class TsInspector {
+public:
+  static constexpr size_t PACKET_SIZE = 188;
+  static constexpr int PID_COUNT = 8192;
+
+  // An empty list of PIDs keeps all of them, throws std::runtime_error on PIDs out of range
+  explicit TsInspector(const std::vector<int>& pids);
+
+  // Moves the kept packets to the beginning of the payload and returns their total size.
+  // Without filtering the payload is left intact, broken packets included, and its size is returned.
+  // Meant to be called by the single thread receiving the connection's data.
+  size_t Inspect(char* data, size_t size);
+
+  TsStats ReadStats() const;
+
+private:
+  static constexpr uint8_t SYNC_BYTE = 0x47;
+  static constexpr int NULL_PID = 0x1FFF;
+
+  // Returns the packet's PID after updating the continuity and PCR state of the PID
+  int InspectPacket(const uint8_t* packet, uint64_t& discontinuities, uint64_t& pcrs);
+
+private:
+  std::bitset<PID_COUNT> allowed_pids;
+  const bool filtering;
+
+  // last continuity counter of every PID, -1 before the PID's first packet
+  std::array<int8_t, PID_COUNT> continuity_counters;
+
+  std::atomic<uint64_t> packets{0};
+  std::atomic<uint64_t> forwarded_packets{0};
+  std::atomic<uint64_t> sync_errors{0};
+  std::atomic<uint64_t> cc_errors{0};
+  std::atomic<uint64_t> pcr_count{0};
+  std::atomic<int64_t> last_pcr{-1};
+  std::atomic<int> last_pcr_pid{-1};
+};
@@ -5,25 +5,70 @@
 
 #include <srt/srt.h>
 
-static void close_all_connections(State* state) {
-  std::vector<int> conn_ids;
-  {
-    std::shared_lock lock(state->conn_receivers_mutex);
-    conn_ids.reserve(state->conn_receivers.size());
-    for (const auto& entry : state->conn_receivers) {
-      conn_ids.push_back(entry.first);
-    }
+// Process receiving the messages of a server's connection, attached to the connection when accepting it
+struct ConnectionReceiver : Server::ConnectionContext {
+  explicit ConnectionReceiver(UnifexPid pid) : pid(pid) {}
+
+  const UnifexPid pid;
+};
+
+static const UnifexPid* connection_receiver(Server::ConnectionContext* context) {
+  if (context == nullptr) {
+    return nullptr;
   }
 
-  for (const auto conn_id : conn_ids) {
+  return &static_cast<ConnectionReceiver*>(context)->pid;
+}
+
+static void close_all_connections(State* state) {
+  for (const auto conn_id : state->server->ActiveSockets()) {
     state->server->CloseConnection(conn_id);
   }
 }
 
+// Server callbacks get invoked from several native threads (listener, workers and libsrt's own threads),
+// so each thread builds its messages in a separate environment and receives into a separate slab
+static UnifexEnv* thread_env() {
+  static thread_local std::unique_ptr<UnifexEnv, decltype(&enif_free_env)> env(enif_alloc_env(),
+                                                                             &enif_free_env);
+  return env.get();
+}
+
+static PayloadSlab& thread_receive_slab() {
+  static thread_local PayloadSlab slab;
+  return slab;
+}
+
+// Data messages are built by hand, as packets are binaries pointing into the receive slab
+// which can't be expressed with unifex payloads
+static UNIFEX_TERM make_packet_list(UnifexEnv* env, const std::vector<std::string_view>& packets) {
+  std::vector<UNIFEX_TERM> terms(packets.size());
+
+  for (size_t i = 0; i < packets.size(); i++) {
+    terms[i] = thread_receive_slab().MakeBinary(env, packets[i].data(), packets[i].size());
+  }
+
+  return enif_make_list_from_array(env, terms.data(), terms.size());
+}
+
+static void send_data_message(
+    UnifexEnv* env, UnifexPid pid, const char* label, int conn, UNIFEX_TERM data) {
+  auto message = enif_make_tuple3(env, enif_make_atom(env, label), enif_make_int(env, conn), data);
+
+  if (!enif_send(nullptr, &pid, env, message)) {
+    NativeMetrics::Global().send_failures.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  enif_clear_env(env);
+}
+
 int on_load(UnifexEnv* env, void** priv_data) {
-  UNIFEX_UNUSED(env);
   UNIFEX_UNUSED(priv_data);
 
+  if (!PayloadSlab::Init(env)) {
+    return 1;
+  }
+
   srt_startup();
 
   if (const char* env_p = std::getenv("SRT_LOG_LEVEL")) {
@@ -55,6 +100,8 @@ void on_unload(UnifexEnv* env, void* priv_data) {
 void handle_destroy_state(UnifexEnv* env, UnifexState* state) {
   UNIFEX_UNUSED(env);
 
+  state->stats_sampler = nullptr;
+
   if (state->server) {
     state->server->Stop();
   }
@@ -66,6 +113,19 @@ void handle_destroy_state(UnifexEnv* env, UnifexState* state) {
   state->~State();
 }
 
+native_histogram map_native_histogram(const AtomicHistogram& histogram) {
+  auto summary = histogram.Summarize();
+
+  native_histogram native;
+  native.count = summary.count;
+  native.sum = summary.sum;
+  native.max = summary.max;
+  native.p50 = summary.p50;
+  native.p99 = summary.p99;
+
+  return native;
+}
+
 srt_socket_stats map_socket_stats(SrtSocketStats* stats) {
   srt_socket_stats srt_stats;
 
@@ -121,15 +181,137 @@ srt_socket_stats map_socket_stats(SrtSocketStats* stats) {
   srt_stats.pktRcvBelated = stats->pktRcvBelated;
   srt_stats.pktSndDrop = stats->pktSndDrop;
   srt_stats.pktRcvDrop = stats->pktRcvDrop;
+  srt_stats.msRTT = stats->msRTT;
+  srt_stats.mbpsBandwidth = stats->mbpsBandwidth;
+  srt_stats.mbpsMaxBW = stats->mbpsMaxBW;
+  srt_stats.pktFlightSize = stats->pktFlightSize;
+  srt_stats.pktCongestionWindow = stats->pktCongestionWindow;
+  srt_stats.byteAvailSndBuf = stats->byteAvailSndBuf;
+  srt_stats.byteAvailRcvBuf = stats->byteAvailRcvBuf;
+  srt_stats.msSndBuf = stats->msSndBuf;
+  srt_stats.msRcvBuf = stats->msRcvBuf;
+  srt_stats.msSndTsbPdDelay = stats->msSndTsbPdDelay;
+  srt_stats.msRcvTsbPdDelay = stats->msRcvTsbPdDelay;
 
   return srt_stats;
 }
 
+srt_aggregate_stats map_aggregate_stats(SrtAggregateStats* stats) {
+  srt_aggregate_stats srt_stats;
+
+  srt_stats.connections = stats->connections;
+  srt_stats.pktSentTotal = stats->pktSentTotal;
+  srt_stats.pktRecvTotal = stats->pktRecvTotal;
+  srt_stats.pktSndLossTotal = stats->pktSndLossTotal;
+  srt_stats.pktRcvLossTotal = stats->pktRcvLossTotal;
+  srt_stats.pktRetransTotal = stats->pktRetransTotal;
+  srt_stats.pktSndDropTotal = stats->pktSndDropTotal;
+  srt_stats.pktRcvDropTotal = stats->pktRcvDropTotal;
+  srt_stats.byteSentTotal = stats->byteSentTotal;
+  srt_stats.byteRecvTotal = stats->byteRecvTotal;
+  srt_stats.byteRetransTotal = stats->byteRetransTotal;
+  srt_stats.byteSndDropTotal = stats->byteSndDropTotal;
+  srt_stats.byteRcvDropTotal = stats->byteRcvDropTotal;
+  srt_stats.mbpsSendRate = stats->mbpsSendRate;
+  srt_stats.mbpsRecvRate = stats->mbpsRecvRate;
+  srt_stats.msRTTMin = stats->msRTT.min;
+  srt_stats.msRTTP50 = stats->msRTT.p50;
+  srt_stats.msRTTP99 = stats->msRTT.p99;
+  srt_stats.msRTTMax = stats->msRTT.max;
+  srt_stats.mbpsBandwidthMin = stats->mbpsBandwidth.min;
+  srt_stats.mbpsBandwidthP50 = stats->mbpsBandwidth.p50;
+  srt_stats.mbpsBandwidthP99 = stats->mbpsBandwidth.p99;
+  srt_stats.mbpsBandwidthMax = stats->mbpsBandwidth.max;
+  srt_stats.rcvBufFillMin = stats->rcvBufFill.min;
+  srt_stats.rcvBufFillP50 = stats->rcvBufFill.p50;
+  srt_stats.rcvBufFillP99 = stats->rcvBufFill.p99;
+  srt_stats.rcvBufFillMax = stats->rcvBufFill.max;
+
+  return srt_stats;
+}
+
+srt_stats_sample map_stats_sample(const SrtStatsSample& sample) {
+  srt_stats_sample srt_sample;
+
+  srt_sample.conn = sample.socket;
+  srt_sample.msInterval = sample.msInterval;
+  srt_sample.pktSent = sample.pktSent;
+  srt_sample.pktRecv = sample.pktRecv;
+  srt_sample.pktSndLoss = sample.pktSndLoss;
+  srt_sample.pktRcvLoss = sample.pktRcvLoss;
+  srt_sample.pktRetrans = sample.pktRetrans;
+  srt_sample.pktSndDrop = sample.pktSndDrop;
+  srt_sample.pktRcvDrop = sample.pktRcvDrop;
+  srt_sample.byteSent = sample.byteSent;
+  srt_sample.byteRecv = sample.byteRecv;
+  srt_sample.pktSendRate = sample.pktSendRate;
+  srt_sample.pktRecvRate = sample.pktRecvRate;
+  srt_sample.mbpsSendRate = sample.mbpsSendRate;
+  srt_sample.mbpsRecvRate = sample.mbpsRecvRate;
+  srt_sample.msRTT = sample.msRTT;
+  srt_sample.mbpsBandwidth = sample.mbpsBandwidth;
+
+  return srt_sample;
+}
+
+SocketOptions make_socket_options(const srt_socket_options& options) {
+  SocketOptions socket_options;
+  socket_options.rcvbuf = options.rcvbuf;
+  socket_options.sndbuf = options.sndbuf;
+  socket_options.fc = options.fc;
+  socket_options.maxbw = options.maxbw;
+  socket_options.inputbw = options.inputbw;
+  socket_options.oheadbw = options.oheadbw;
+  socket_options.tlpktdrop = options.tlpktdrop;
+  socket_options.nakreport = options.nakreport;
+  socket_options.peerlatency = options.peerlatency;
+  socket_options.congestion = options.congestion;
+  socket_options.mss = options.mss;
+
+  return socket_options;
+}
+
+TransferOptions make_transfer_options(int file_mode,
+                                      int payload_size,
+                                      int message_api,
+                                      int max_message_size) {
+  TransferOptions options;
+  options.file_mode = file_mode;
+  options.payload_size = payload_size;
+  options.message_api = message_api;
+  options.max_message_size = max_message_size;
+
+  return options;
+}
+
+// checked before pinning, so that an oversized payload is reported without failing the send
+bool exceeds_message_size(UnifexEnv* env, UNIFEX_TERM payload, int max_message_size) {
+  ErlNifBinary binary;
+
+  return enif_inspect_binary(env, payload, &binary) &&
+         binary.size > static_cast<size_t>(max_message_size);
+}
+
 UNIFEX_TERM start_server(UnifexEnv* env,
                          char* address,
                          int port,
                          char* password,
-                         int latency_ms) {
+                         int latency_ms,
+                         int batch_max_packets,
+                         int batch_max_bytes,
+                         int batch_max_time_us,
+                         int workers,
+                         int listen_backlog,
+                         int connect_request_timeout_ms,
+                         int send_queue_capacity,
+                         int file_mode,
+                         int payload_size,
+                         int message_api,
+                         int max_message_size,
+                         srt_socket_options socket_options,
+                         int ts_inspection,
+                         int* ts_pids,
+                         unsigned int ts_pids_length) {
   State* state = unifex_alloc_state(env);
   state = new (state) State();
 
@@ -139,57 +321,70 @@ UNIFEX_TERM start_server(UnifexEnv* env,
       throw std::runtime_error("failed to create native state");
     };
 
-    state->server = std::make_unique<Server>();
+    state->server = std::make_unique<Server>(workers);
 
     state->server->SetOnSocketConnected(
-        [=](Server::SrtSocket socket, const std::string& stream_id) {
-          std::lock_guard lock(state->conn_receivers_mutex);
-
-          if (auto it = state->conn_receivers.find(socket); it != std::end(state->conn_receivers)) {
-            send_srt_server_conn(
-                state->env, it->second, 1, socket, stream_id.c_str());
+        [=](Server::SrtSocket socket, Server::ConnectionContext* context, const std::string& stream_id) {
+          if (auto receiver = connection_receiver(context)) {
+            send_srt_server_conn(thread_env(), *receiver, 1, socket, stream_id.c_str());
           }
-
         });
 
-    state->server->SetOnSocketDisconnected([=](Server::SrtSocket socket) {
-      std::lock_guard lock(state->conn_receivers_mutex);
-
-      if (auto it = state->conn_receivers.find(socket); it != std::end(state->conn_receivers)) {
-        send_srt_server_conn_closed(state->env, it->second, 1, socket);
-      }
+    state->server->SetOnSocketDisconnected(
+        [=](Server::SrtSocket socket, Server::ConnectionContext* context) {
+          if (auto receiver = connection_receiver(context)) {
+            send_srt_server_conn_closed(thread_env(), *receiver, 1, socket);
+          }
+        });
 
-      state->conn_receivers.erase(socket);
-    });
+    state->server->SetReceiveBufferProvider(
+        [=](size_t size) { return thread_receive_slab().Reserve(size); });
 
+    // the receiver comes with the connection, so the data path takes no locks of its own
     state->server->SetOnSocketData(
-        [=](Server::SrtSocket socket, const char* data, int len) {
-          UnifexPayload* payload =
-              (UnifexPayload*)unifex_alloc(sizeof(UnifexPayload));
-
-          unifex_payload_alloc(state->env, UNIFEX_PAYLOAD_BINARY, len, payload);
+        [=](Server::SrtSocket socket, Server::ConnectionContext* context, const char* data, int len) {
+          if (auto receiver = connection_receiver(context)) {
+            auto packet = thread_receive_slab().MakeBinary(thread_env(), data, len);
 
-          memcpy(payload->data, data, len);
-
-          {
-            std::unique_lock lock(state->conn_receivers_mutex);
-            if (auto it = state->conn_receivers.find(socket); it != std::end(state->conn_receivers)) {
-              // TODO: make sure that the message has been properly sent
-              send_srt_data(state->env, it->second, 1, socket, payload);
-            }
+            send_data_message(thread_env(), *receiver, "srt_data", socket, packet);
           }
+        });
 
-          unifex_payload_release(payload);
+    state->server->SetOnSocketDataBatch([=](Server::SrtSocket socket,
+                                            Server::ConnectionContext* context,
+                                            const std::vector<std::string_view>& packets) {
+      if (auto receiver = connection_receiver(context)) {
+        auto list = make_packet_list(thread_env(), packets);
 
-          unifex_free(payload);
-        });
+        send_data_message(thread_env(), *receiver, "srt_data_batch", socket, list);
+      }
+    });
 
     state->server->SetOnConnectRequest(
-        [=](const std::string& address, const std::string& stream_id) {
+        [=](Server::SrtSocket request_id, const std::string& address, const std::string& stream_id) {
           send_srt_server_connect_request(
-              state->env, state->owner, 1, address.c_str(), stream_id.c_str());
+              thread_env(), state->owner, 1, address.c_str(), stream_id.c_str(), request_id);
+        });
+
+    // connections admitted by the native rules are owned by the process that started the server
+    state->server->SetOnConnectRequestAdmitted(
+        [=](Server::SrtSocket, const std::string&, const std::string&) {
+          return std::make_shared<ConnectionReceiver>(state->owner);
         });
 
+    state->server->SetListenBacklog(listen_backlog);
+    state->server->SetConnectRequestTimeout(connect_request_timeout_ms);
+    state->server->SetSendQueueCapacity(send_queue_capacity);
+    state->server->SetTransferOptions(
+        make_transfer_options(file_mode, payload_size, message_api, max_message_size));
+    state->server->SetSocketOptions(make_socket_options(socket_options));
+
+    if (ts_inspection) {
+      state->server->EnableTsInspection(std::vector<int>(ts_pids, ts_pids + ts_pids_length));
+    }
+
+    state->server->SetReceiveBatching(batch_max_packets, batch_max_bytes, batch_max_time_us);
+
     state->server->Run(std::string(address), port, std::string(password), latency_ms);
 
     UNIFEX_TERM result = start_server_result_ok(env, state);
@@ -203,19 +398,27 @@ UNIFEX_TERM start_server(UnifexEnv* env,
   }
 }
 
-UNIFEX_TERM accept_awaiting_connect_request(UnifexEnv *env, UnifexPid receiver,
+UNIFEX_TERM accept_awaiting_connect_request(UnifexEnv *env, int request_id, UnifexPid receiver,
+                                            srt_socket_options socket_options,
                                             UnifexState *state) {
   if (state->server == nullptr) {
     return accept_awaiting_connect_request_result_error(env, "Server is not active");
   }
 
-  auto id = state->server->GetAwaitingConnectionRequestId();
-  state->server->AnswerConnectRequest(true);
-
-  std::lock_guard lock(state->conn_receivers_mutex);
-  state->conn_receivers.insert({id, receiver});
+  try {
+    // the receiver gets attached together with the answer, before the connection can get established
+    auto id = state->server->AnswerConnectRequest(request_id,
+                                                  true,
+                                                  std::make_shared<ConnectionReceiver>(receiver),
+                                                  make_socket_options(socket_options));
+    if (id == -1) {
+      return accept_awaiting_connect_request_result_error(env, "Connect request not found");
+    }
 
-  return accept_awaiting_connect_request_result_ok(env);
+    return accept_awaiting_connect_request_result_ok(env);
+  } catch (const std::exception& e) {
+    return accept_awaiting_connect_request_result_error(env, e.what());
+  }
 }
 
 UNIFEX_TERM read_server_socket_stats(UnifexEnv* env, int conn_id, UnifexState* state) {
@@ -233,23 +436,151 @@ UNIFEX_TERM read_server_socket_stats(UnifexEnv* env, int conn_id, UnifexState* s
   return read_server_socket_stats_result_ok(env, srt_stats);
 }
 
+UNIFEX_TERM read_server_ts_stats(UnifexEnv* env, int conn_id, UnifexState* state) {
+  if (state->server == nullptr) {
+    return read_server_ts_stats_result_error(env, "Server is not active");
+  }
+
+  auto stats = state->server->ReadTsStats(conn_id);
+  if (!stats) {
+    return read_server_ts_stats_result_error(env, "Socket not found or TS inspection disabled");
+  }
+
+  srt_ts_stats ts_stats;
+  ts_stats.packets = stats->packets;
+  ts_stats.forwarded_packets = stats->forwarded_packets;
+  ts_stats.sync_errors = stats->sync_errors;
+  ts_stats.cc_errors = stats->cc_errors;
+  ts_stats.pcr_count = stats->pcr_count;
+  ts_stats.last_pcr = stats->last_pcr;
+  ts_stats.last_pcr_pid = stats->last_pcr_pid;
+
+  return read_server_ts_stats_result_ok(env, ts_stats);
+}
+
+UNIFEX_TERM read_server_latency_histograms(UnifexEnv* env, int conn_id, UnifexState* state) {
+  if (state->server == nullptr) {
+    return read_server_latency_histograms_result_error(env, "Server is not active");
+  }
+
+  auto counts = state->server->ReadLatencyHistograms(conn_id);
+  if (!counts) {
+    return read_server_latency_histograms_result_error(env, "Socket not found");
+  }
+
+  std::vector<double> bounds(RollingHistogram::BUCKET_BOUNDS.begin(),
+                             RollingHistogram::BUCKET_BOUNDS.end());
+
+  return read_server_latency_histograms_result_ok(env,
+                                                  bounds.data(),
+                                                  bounds.size(),
+                                                  counts->rtt.data(),
+                                                  counts->rtt.size(),
+                                                  counts->rcv_buf_delay.data(),
+                                                  counts->rcv_buf_delay.size());
+}
+
+UNIFEX_TERM read_server_aggregate_stats(UnifexEnv* env, UnifexState* state) {
+  if (state->server == nullptr) {
+    return read_server_aggregate_stats_result_error(env, "Server is not active");
+  }
+
+  auto stats = state->server->ReadAggregateStats();
+  auto srt_stats = map_aggregate_stats(stats.get());
+
+  return read_server_aggregate_stats_result_ok(env, srt_stats);
+}
+
 UNIFEX_TERM reject_awaiting_connect_request(UnifexEnv* env,
+                                            int request_id,
                                             UnifexState* state) {
   if (state->server == nullptr) {
-    return accept_awaiting_connect_request_result_error(env, "Server is not active");
+    return reject_awaiting_connect_request_result_error(env, "Server is not active");
+  }
+
+  if (state->server->AnswerConnectRequest(request_id, false) == -1) {
+    return reject_awaiting_connect_request_result_error(env, "Connect request not found");
+  }
+
+  return reject_awaiting_connect_request_result_ok(env);
+}
+
+
+UNIFEX_TERM set_server_admission_rules(UnifexEnv* env,
+                                      int max_connections,
+                                      char** allowed_peers,
+                                      unsigned int allowed_peers_length,
+                                      char** denied_peers,
+                                      unsigned int denied_peers_length,
+                                      char** stream_rule_actions,
+                                      unsigned int stream_rule_actions_length,
+                                      char** stream_rule_matches,
+                                      unsigned int stream_rule_matches_length,
+                                      char** stream_rule_patterns,
+                                      unsigned int stream_rule_patterns_length,
+                                      UnifexState* state) {
+  if (state->server == nullptr) {
+    return set_server_admission_rules_result_error(env, "Server is not active");
+  }
+
+  if (stream_rule_actions_length != stream_rule_matches_length ||
+      stream_rule_actions_length != stream_rule_patterns_length) {
+    return set_server_admission_rules_result_error(env, "Malformed stream rules");
   }
 
-  state->server->AnswerConnectRequest(false);
+  try {
+    auto rules = std::make_shared<AdmissionRules>();
+
+    rules->SetMaxConnections(max_connections);
+
+    for (unsigned int i = 0; i < allowed_peers_length; i++) {
+      rules->AddAllowedPeer(allowed_peers[i]);
+    }
+
+    for (unsigned int i = 0; i < denied_peers_length; i++) {
+      rules->AddDeniedPeer(denied_peers[i]);
+    }
 
-  return accept_awaiting_connect_request_result_ok(env);
+    for (unsigned int i = 0; i < stream_rule_actions_length; i++) {
+      AdmissionRules::StreamMatch match;
+
+      if (strcmp(stream_rule_matches[i], "exact") == 0) {
+        match = AdmissionRules::StreamMatch::Exact;
+      } else if (strcmp(stream_rule_matches[i], "prefix") == 0) {
+        match = AdmissionRules::StreamMatch::Prefix;
+      } else if (strcmp(stream_rule_matches[i], "access_control") == 0) {
+        match = AdmissionRules::StreamMatch::AccessControl;
+      } else {
+        throw std::runtime_error(std::string("Invalid stream rule match: ") + stream_rule_matches[i]);
+      }
+
+      rules->AddStreamRule(match, stream_rule_patterns[i], strcmp(stream_rule_actions[i], "accept") == 0);
+    }
+
+    state->server->SetAdmissionRules(std::move(rules));
+
+    return set_server_admission_rules_result_ok(env);
+  } catch (const std::exception& e) {
+    return set_server_admission_rules_result_error(env, e.what());
+  }
 }
 
+UNIFEX_TERM clear_server_admission_rules(UnifexEnv* env, UnifexState* state) {
+  if (state->server == nullptr) {
+    return clear_server_admission_rules_result_error(env, "Server is not active");
+  }
+
+  state->server->SetAdmissionRules(nullptr);
+
+  return clear_server_admission_rules_result_ok(env);
+}
 
 UNIFEX_TERM stop_server(UnifexEnv* env, UnifexState* state) {
   if (state->server == nullptr) {
     return stop_server_result_error(env, "Server is not active");
   }
 
+  state->stats_sampler = nullptr;
   close_all_connections(state);
   state->server->Stop();
   state->server = nullptr;
@@ -257,6 +588,52 @@ UNIFEX_TERM stop_server(UnifexEnv* env, UnifexState* state) {
   return stop_server_result_ok(env);
 }
 
+UNIFEX_TERM start_server_stats_sampler(UnifexEnv* env,
+                                       int interval_ms,
+                                       UnifexPid subscriber,
+                                       UnifexState* state) {
+  if (state->server == nullptr) {
+    return start_server_stats_sampler_result_error(env, "Server is not active");
+  }
+
+  if (interval_ms <= 0) {
+    return start_server_stats_sampler_result_error(env, "Invalid sampling interval");
+  }
+
+  // the sampler gets stopped before the server goes away
+  auto server = state->server.get();
+
+  state->stats_sampler = nullptr;
+  state->stats_sampler = std::make_unique<StatsSampler>(
+      interval_ms,
+      [server]() { return server->ActiveSockets(); },
+      [subscriber](const std::vector<SrtStatsSample>& samples) {
+        std::vector<srt_stats_sample> srt_samples;
+        srt_samples.reserve(samples.size());
+
+        for (const auto& sample : samples) {
+          srt_samples.push_back(map_stats_sample(sample));
+        }
+
+        auto env = thread_env();
+        send_srt_server_stats(env, subscriber, 1, srt_samples.data(), srt_samples.size());
+        enif_clear_env(env);
+      });
+  state->stats_sampler->Start();
+
+  return start_server_stats_sampler_result_ok(env);
+}
+
+UNIFEX_TERM stop_server_stats_sampler(UnifexEnv* env, UnifexState* state) {
+  if (state->server == nullptr) {
+    return stop_server_stats_sampler_result_error(env, "Server is not active");
+  }
+
+  state->stats_sampler = nullptr;
+
+  return stop_server_stats_sampler_result_ok(env);
+}
+
 UNIFEX_TERM
 close_server_connection(UnifexEnv* env, int conn_id, UnifexState* state) {
   if (state->server == nullptr) {
@@ -270,13 +647,89 @@ close_server_connection(UnifexEnv* env, int conn_id, UnifexState* state) {
   return close_server_connection_result_ok(env);
 }
 
+UNIFEX_TERM add_server_relay_route(UnifexEnv* env,
+                                   char* stream_id,
+                                   UnifexState* client,
+                                   UnifexState* state) {
+  if (state->server == nullptr) {
+    return add_server_relay_route_result_error(env, "Server is not active");
+  }
+
+  if (client->client == nullptr) {
+    return add_server_relay_route_result_error(env, "Client is not active");
+  }
+
+  // a receiver never gets the sender loop running, so the relayed packets would just be lost
+  if (!client->client->IsSender()) {
+    return add_server_relay_route_result_error(env, "Client is in receiver mode");
+  }
+
+  state->server->AddRelayRoute(std::string(stream_id), client->client);
+
+  return add_server_relay_route_result_ok(env);
+}
+
+UNIFEX_TERM remove_server_relay_route(UnifexEnv* env,
+                                      char* stream_id,
+                                      UnifexState* client,
+                                      UnifexState* state) {
+  if (state->server == nullptr) {
+    return remove_server_relay_route_result_error(env, "Server is not active");
+  }
+
+  if (client->client == nullptr) {
+    return remove_server_relay_route_result_error(env, "Client is not active");
+  }
+
+  state->server->RemoveRelayRoute(std::string(stream_id), client->client.get());
+
+  return remove_server_relay_route_result_ok(env);
+}
+
+UNIFEX_TERM send_server_data(UnifexEnv* env,
+                             UNIFEX_TERM payload,
+                             int* conn_ids,
+                             unsigned int conn_ids_length,
+                             UnifexState* state) {
+  if (state->server == nullptr) {
+    return send_server_data_result_error(env, "Server is not active");
+  }
+
+  if (exceeds_message_size(env, payload, state->server->MaxMessageSize())) {
+    return send_server_data_result_error_payload_too_large(env);
+  }
+
+  try {
+    // the payload gets pinned once and shared by all the connections instead of being copied
+    auto failed = state->server->Send(std::vector<Server::SrtSocket>(conn_ids, conn_ids + conn_ids_length),
+                                      PayloadPins::PinShared(payload));
+
+    return send_server_data_result_ok(env, failed.data(), failed.size());
+  } catch (const std::exception& e) {
+    return send_server_data_result_error(env, e.what());
+  }
+}
+
 UNIFEX_TERM
 start_client(UnifexEnv* env,
              char* server_address,
              int port,
              char* stream_id,
              char* password,
-             int latency_ms) {
+             int latency_ms,
+             int send_queue_capacity,
+             int send_ttl_ms,
+             int non_blocking,
+             int send_queue_low_watermark,
+             int linger_ms,
+             int receiver,
+             int batch_max_packets,
+             int batch_max_bytes,
+             int file_mode,
+             int payload_size,
+             int message_api,
+             int max_message_size,
+             srt_socket_options socket_options) {
   State* state = unifex_alloc_state(env);
   state = new (state) State();
 
@@ -286,7 +739,10 @@ start_client(UnifexEnv* env,
       throw std::runtime_error("failed to create native state");
     };
 
-    state->client = std::make_unique<Client>(10, 200);
+    state->client = std::make_shared<Client>(
+        send_queue_capacity, send_ttl_ms, receiver ? Client::Mode::Receiver : Client::Mode::Sender);
+    state->client_payload_pins =
+        std::make_unique<PayloadPins>(state->client->SendQueueCapacity());
 
     state->client->SetOnSocketConnected(
         [=]() { send_srt_client_connected(state->env, state->owner, 1); });
@@ -298,6 +754,33 @@ start_client(UnifexEnv* env,
       send_srt_client_error(state->env, state->owner, 1, reason.c_str());
     });
 
+    state->client->SetNonBlockingSend(non_blocking, send_queue_low_watermark);
+    state->client->SetLinger(linger_ms);
+    state->client->SetReceiveBatching(batch_max_packets, batch_max_bytes);
+    state->client->SetTransferOptions(
+        make_transfer_options(file_mode, payload_size, message_api, max_message_size));
+    state->client->SetSocketOptions(make_socket_options(socket_options));
+
+    state->client->SetReceiveBufferProvider(
+        [](size_t size) { return thread_receive_slab().Reserve(size); });
+
+    state->client->SetOnSocketDataBatch([=](const std::vector<std::string_view>& packets) {
+      auto env = thread_env();
+      auto message = enif_make_tuple2(
+          env, enif_make_atom(env, "srt_client_data_batch"), make_packet_list(env, packets));
+
+      if (!enif_send(nullptr, &state->owner, env, message)) {
+        NativeMetrics::Global().send_failures.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      enif_clear_env(env);
+    });
+    state->client->SetOnSendQueueReady(
+        [=]() { send_srt_client_ready(state->env, state->owner, 1); });
+
+    state->client->SetOnPayloadReleased(
+        [pins = state->client_payload_pins.get()](int slot) { pins->Release(slot); });
+
     state->client->Run(std::string(server_address),
                        port,
                        std::string(stream_id),
@@ -323,17 +806,22 @@ start_client(UnifexEnv* env,
 
 
 UNIFEX_TERM
-send_client_data(UnifexEnv* env, UnifexPayload* payload, UnifexState* state) {
+send_client_data(UnifexEnv* env, UNIFEX_TERM payload, UnifexState* state) {
   if (state->client == nullptr) {
     return send_client_data_result_error(env, "Client is not active");
   } 
 
-  try {
-    auto buffer = std::unique_ptr<char[]>(new char[payload->size]);
+  if (exceeds_message_size(env, payload, state->client->MaxMessageSize())) {
+    return send_client_data_result_error_payload_too_large(env);
+  }
 
-    memcpy(buffer.get(), payload->data, payload->size);
+  try {
+    auto pins = state->client_payload_pins.get();
 
-    state->client->Send(std::move(buffer), payload->size);
+    // the payload is referenced by the send queue until it gets sent instead of being copied
+    if (!state->client->Send([=](int slot) { return pins->Pin(slot, payload); })) {
+      return send_client_data_result_error_would_block(env);
+    }
 
     return send_client_data_result_ok(env);
   } catch (const std::exception& e) {
@@ -341,6 +829,33 @@ send_client_data(UnifexEnv* env, UnifexPayload* payload, UnifexState* state) {
   }
 }
 
+UNIFEX_TERM send_client_data_batch(UnifexEnv* env,
+                                   UNIFEX_TERM* payloads,
+                                   unsigned int payloads_length,
+                                   UnifexState* state) {
+  if (state->client == nullptr) {
+    return send_client_data_batch_result_error(env, "Client is not active");
+  }
+
+  // the whole batch gets rejected up front, so that no part of it ends up enqueued
+  for (unsigned int i = 0; i < payloads_length; i++) {
+    if (exceeds_message_size(env, payloads[i], state->client->MaxMessageSize())) {
+      return send_client_data_batch_result_error_payload_too_large(env);
+    }
+  }
+
+  try {
+    auto pins = state->client_payload_pins.get();
+
+    int accepted = state->client->SendBatch(
+        payloads_length, [=](int slot, int index) { return pins->Pin(slot, payloads[index]); });
+
+    return send_client_data_batch_result_ok(env, accepted);
+  } catch (const std::exception& e) {
+    return send_client_data_batch_result_error(env, e.what());
+  }
+}
+
 UNIFEX_TERM read_client_socket_stats(UnifexEnv* env, UnifexState* state) {
   if (state->client == nullptr) {
     return read_client_socket_stats_result_error(env, "Client is not active");
@@ -356,13 +871,88 @@ UNIFEX_TERM read_client_socket_stats(UnifexEnv* env, UnifexState* state) {
   return read_client_socket_stats_result_ok(env, srt_stats);
 }
 
+UNIFEX_TERM read_client_latency_histograms(UnifexEnv* env, UnifexState* state) {
+  if (state->client == nullptr) {
+    return read_client_latency_histograms_result_error(env, "Client is not active");
+  }
+
+  auto counts = state->client->ReadLatencyHistograms();
+  std::vector<double> bounds(RollingHistogram::BUCKET_BOUNDS.begin(),
+                             RollingHistogram::BUCKET_BOUNDS.end());
+
+  return read_client_latency_histograms_result_ok(env,
+                                                  bounds.data(),
+                                                  bounds.size(),
+                                                  counts->rtt.data(),
+                                                  counts->rtt.size(),
+                                                  counts->rcv_buf_delay.data(),
+                                                  counts->rcv_buf_delay.size());
+}
+
+UNIFEX_TERM start_client_stats_sampler(UnifexEnv* env,
+                                       int interval_ms,
+                                       UnifexPid subscriber,
+                                       UnifexState* state) {
+  if (state->client == nullptr) {
+    return start_client_stats_sampler_result_error(env, "Client is not active");
+  }
+
+  if (interval_ms <= 0) {
+    return start_client_stats_sampler_result_error(env, "Invalid sampling interval");
+  }
+
+  auto client = state->client;
+
+  state->stats_sampler = nullptr;
+  state->stats_sampler = std::make_unique<StatsSampler>(
+      interval_ms,
+      [client]() {
+        auto socket = client->Socket();
+
+        return socket == -1 ? std::vector<int>{} : std::vector<int>{socket};
+      },
+      [subscriber](const std::vector<SrtStatsSample>& samples) {
+        auto env = thread_env();
+        send_srt_client_stats(env, subscriber, 1, map_stats_sample(samples.front()));
+        enif_clear_env(env);
+      });
+  state->stats_sampler->Start();
+
+  return start_client_stats_sampler_result_ok(env);
+}
+
+UNIFEX_TERM stop_client_stats_sampler(UnifexEnv* env, UnifexState* state) {
+  if (state->client == nullptr) {
+    return stop_client_stats_sampler_result_error(env, "Client is not active");
+  }
+
+  state->stats_sampler = nullptr;
+
+  return stop_client_stats_sampler_result_ok(env);
+}
+
 UNIFEX_TERM stop_client(UnifexEnv* env, UnifexState* state) {
   if (state->client == nullptr) {
     return stop_client_result_error(env, "Client is not active");
   }
 
+  state->stats_sampler = nullptr;
+
   state->client->Stop();
   state->client = nullptr;
 
   return stop_client_result_ok(env);
 }
+
+UNIFEX_TERM read_native_metrics(UnifexEnv* env) {
+  auto& metrics = NativeMetrics::Global();
+
+  return read_native_metrics_result_ok(env,
+                                       metrics.send_failures.load(),
+                                       metrics.epoll_wakeups.load(),
+                                       map_native_histogram(metrics.data_callback_us),
+                                       map_native_histogram(metrics.connection_lookup_us),
+                                       map_native_histogram(metrics.client_send_queue_depth),
+                                       map_native_histogram(metrics.client_send_queue_time_us),
+                                       map_native_histogram(metrics.packets_per_wakeup));
+}
@@ -1,18 +1,24 @@
 #pragma once
 
 #include "client/client.h"
+#include "common/native_metrics.h"
+#include "common/payload_pins.h"
+#include "common/payload_slab.h"
+#include "common/stats_sampler.h"
 #include "server/server.h"
 #include <memory>
-#include <shared_mutex>
 #include <unifex/unifex.h>
 
 typedef struct SRTState {
   UnifexPid owner;
   UnifexEnv* env;
-  std::unordered_map<int, UnifexPid> conn_receivers; 
-  std::shared_mutex conn_receivers_mutex;
   std::unique_ptr<Server> server;
-  std::unique_ptr<Client> client;
+  // declared before the client, so that it outlives the client's sending thread
+  std::unique_ptr<PayloadPins> client_payload_pins;
+  // shared with the relay routes the client is a target of
+  std::shared_ptr<Client> client;
+  // declared last, as it reads from the server or the client until stopped
+  std::unique_ptr<StatsSampler> stats_sampler;
 } State;
 
 #include "_generated/srt_nif.h"
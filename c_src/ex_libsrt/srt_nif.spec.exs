@@ -58,40 +58,168 @@ type srt_socket_stats :: %ExLibSRT.SocketStats{
   pktRcvBelated: int64,
   pktSndDrop: int,
   pktRcvDrop: int,
+  msRTT: float,
+  mbpsBandwidth: float,
+  mbpsMaxBW: float,
+  pktFlightSize: int,
+  pktCongestionWindow: int,
+  byteAvailSndBuf: int,
+  byteAvailRcvBuf: int,
+  msSndBuf: int,
+  msRcvBuf: int,
+  msSndTsbPdDelay: int,
+  msRcvTsbPdDelay: int,
+}
+
+type srt_stats_sample :: %ExLibSRT.StatsSample{
+  conn: int,
+  msInterval: int64,
+  pktSent: int64,
+  pktRecv: int64,
+  pktSndLoss: int,
+  pktRcvLoss: int,
+  pktRetrans: int,
+  pktSndDrop: int,
+  pktRcvDrop: int,
+  byteSent: uint64,
+  byteRecv: uint64,
+  pktSendRate: float,
+  pktRecvRate: float,
+  mbpsSendRate: float,
+  mbpsRecvRate: float,
+  msRTT: float,
+  mbpsBandwidth: float,
+}
+
+type srt_aggregate_stats :: %ExLibSRT.AggregateStats{
+  connections: int,
+  pktSentTotal: int64,
+  pktRecvTotal: int64,
+  pktSndLossTotal: int64,
+  pktRcvLossTotal: int64,
+  pktRetransTotal: int64,
+  pktSndDropTotal: int64,
+  pktRcvDropTotal: int64,
+  byteSentTotal: uint64,
+  byteRecvTotal: uint64,
+  byteRetransTotal: uint64,
+  byteSndDropTotal: uint64,
+  byteRcvDropTotal: uint64,
+  mbpsSendRate: float,
+  mbpsRecvRate: float,
+  msRTTMin: float,
+  msRTTP50: float,
+  msRTTP99: float,
+  msRTTMax: float,
+  mbpsBandwidthMin: float,
+  mbpsBandwidthP50: float,
+  mbpsBandwidthP99: float,
+  mbpsBandwidthMax: float,
+  rcvBufFillMin: float,
+  rcvBufFillP50: float,
+  rcvBufFillP99: float,
+  rcvBufFillMax: float,
+}
+
+type native_histogram :: %ExLibSRT.NativeMetrics.Histogram{
+  count: uint64,
+  sum: uint64,
+  max: uint64,
+  p50: uint64,
+  p99: uint64,
+}
+
+type srt_socket_options :: %ExLibSRT.SocketOptions{
+  rcvbuf: int,
+  sndbuf: int,
+  fc: int,
+  maxbw: int64,
+  inputbw: int64,
+  oheadbw: int,
+  tlpktdrop: int,
+  nakreport: int,
+  peerlatency: int,
+  congestion: string,
+  mss: int,
+}
+
+type srt_ts_stats :: %ExLibSRT.TsStats{
+  packets: uint64,
+  forwarded_packets: uint64,
+  sync_errors: uint64,
+  cc_errors: uint64,
+  pcr_count: uint64,
+  last_pcr: int64,
+  last_pcr_pid: int,
 }
 
 callback :load, :on_load
 callback :unload, :on_unload
 
-spec start_server(host :: string, port :: int, password :: string, latency_ms :: int) :: {:ok :: label, state} | {:error :: label, reason :: string}
+spec read_native_metrics() :: {:ok :: label, send_failures :: uint64, epoll_wakeups :: uint64, data_callback_us :: native_histogram, connection_lookup_us :: native_histogram, client_send_queue_depth :: native_histogram, client_send_queue_time_us :: native_histogram, packets_per_wakeup :: native_histogram}
 
-spec accept_awaiting_connect_request(receiver :: pid, state) :: (:ok :: label) | {:error :: label, reason :: string}
+spec start_server(host :: string, port :: int, password :: string, latency_ms :: int, batch_max_packets :: int, batch_max_bytes :: int, batch_max_time_us :: int, workers :: int, listen_backlog :: int, connect_request_timeout_ms :: int, send_queue_capacity :: int, file_mode :: bool, payload_size :: int, message_api :: bool, max_message_size :: int, socket_options :: srt_socket_options, ts_inspection :: bool, ts_pids :: [int]) :: {:ok :: label, state} | {:error :: label, reason :: string}
 
-spec reject_awaiting_connect_request(state) :: (:ok :: label) | {:error :: label, reason :: string}
+spec accept_awaiting_connect_request(request_id :: int, receiver :: pid, socket_options :: srt_socket_options, state) :: (:ok :: label) | {:error :: label, reason :: string}
+
+spec reject_awaiting_connect_request(request_id :: int, state) :: (:ok :: label) | {:error :: label, reason :: string}
+
+spec set_server_admission_rules(max_connections :: int, allowed_peers :: [string], denied_peers :: [string], stream_rule_actions :: [atom], stream_rule_matches :: [atom], stream_rule_patterns :: [string], state) :: (:ok :: label) | {:error :: label, reason :: string}
+
+spec clear_server_admission_rules(state) :: (:ok :: label) | {:error :: label, reason :: string}
 
 spec read_server_socket_stats(conn_id :: int, state) :: {:ok :: label, stats :: srt_socket_stats} | {:error :: label, reason :: string}
 
+spec read_server_ts_stats(conn_id :: int, state) :: {:ok :: label, stats :: srt_ts_stats} | {:error :: label, reason :: string}
+
+spec read_server_latency_histograms(conn_id :: int, state) :: {:ok :: label, bucket_bounds_ms :: [float], rtt :: [uint64], rcv_buf_delay :: [uint64]} | {:error :: label, reason :: string}
+
+spec read_server_aggregate_stats(state) :: {:ok :: label, stats :: srt_aggregate_stats} | {:error :: label, reason :: string}
+
+spec start_server_stats_sampler(interval_ms :: int, subscriber :: pid, state) :: (:ok :: label) | {:error :: label, reason :: string}
+
+spec stop_server_stats_sampler(state) :: (:ok :: label) | {:error :: label, reason :: string}
+
 spec close_server_connection(conn_id :: int, state) :: (:ok :: label) | {:error :: label, reason :: string}
 
+spec add_server_relay_route(stream_id :: string, client :: state, state) :: (:ok :: label) | {:error :: label, reason :: string}
+
+spec remove_server_relay_route(stream_id :: string, client :: state, state) :: (:ok :: label) | {:error :: label, reason :: string}
+
+spec send_server_data(data :: term, conn_ids :: [int], state) :: {:ok :: label, failed_conn_ids :: [int]} | {:error :: label, :payload_too_large :: label} | {:error :: label, reason :: string}
+
 spec stop_server(state) :: (:ok :: label) | {:error :: label, reason :: string}
 
 
-spec start_client(server_address :: string, port :: int, stream_id :: string, password :: string, latency_ms :: int) :: {:ok :: label, state} | {:error :: label, reason :: string, code :: int}
+spec start_client(server_address :: string, port :: int, stream_id :: string, password :: string, latency_ms :: int, send_queue_capacity :: int, send_ttl_ms :: int, non_blocking :: bool, send_queue_low_watermark :: int, linger_ms :: int, receiver :: bool, batch_max_packets :: int, batch_max_bytes :: int, file_mode :: bool, payload_size :: int, message_api :: bool, max_message_size :: int, socket_options :: srt_socket_options) :: {:ok :: label, state} | {:error :: label, reason :: string, code :: int}
+
+spec send_client_data(data :: term, state) :: (:ok :: label) | {:error :: label, :would_block :: label} | {:error :: label, :payload_too_large :: label} | {:error :: label, reason :: string}
 
-spec send_client_data(data :: payload, state) :: (:ok :: label) | {:error :: label, reason :: string}
+spec send_client_data_batch(data :: [term], state) :: {:ok :: label, accepted :: int} | {:error :: label, :payload_too_large :: label} | {:error :: label, reason :: string}
 
 spec read_client_socket_stats(state) :: {:ok :: label, stats :: srt_socket_stats} | {:error :: label, reason :: string}
 
+spec read_client_latency_histograms(state) :: {:ok :: label, bucket_bounds_ms :: [float], rtt :: [uint64], rcv_buf_delay :: [uint64]} | {:error :: label, reason :: string}
+
+spec start_client_stats_sampler(interval_ms :: int, subscriber :: pid, state) :: (:ok :: label) | {:error :: label, reason :: string}
+
+spec stop_client_stats_sampler(state) :: (:ok :: label) | {:error :: label, reason :: string}
+
 spec stop_client(state) :: (:ok :: label) | {:error :: label, reason :: string}
 
 sends {:srt_server_conn :: label, conn :: int, stream_id :: string}
 sends {:srt_server_conn_closed:: label, conn :: int}
 sends {:srt_server_error :: label, conn :: int, error :: string}
 sends {:srt_data :: label, conn :: int, data :: payload}
-sends {:srt_server_connect_request :: label, address :: string, stream_id :: string}
+sends {:srt_data_batch :: label, conn :: int, packets :: [payload]}
+sends {:srt_server_connect_request :: label, address :: string, stream_id :: string, request_id :: int}
+sends {:srt_server_stats :: label, samples :: [srt_stats_sample]}
 
 sends :srt_client_connected :: label
 sends :srt_client_disconnected :: label
 sends {:srt_client_error :: label, reason :: string}
+sends :srt_client_ready :: label
+sends {:srt_client_data_batch :: label, packets :: [payload]}
+sends {:srt_client_stats :: label, sample :: srt_stats_sample}
 
-dirty :io,  start_server: 4, close_server_connection: 2, stop_server: 1, start_client: 5, read_server_socket_stats: 2, read_client_socket_stats: 1
+dirty :io,  start_server: 18, close_server_connection: 2, send_server_data: 3, stop_server: 1, stop_client: 1, start_client: 18, send_client_data: 2, read_server_socket_stats: 2, read_server_aggregate_stats: 1, read_client_socket_stats: 1, start_server_stats_sampler: 3, stop_server_stats_sampler: 1, start_client_stats_sampler: 3, stop_client_stats_sampler: 1
@@ -77,7 +77,7 @@ defmodule Server do
   end
 
   @impl true
-  def handle_info({:srt_server_connect_request, address, stream_id}, server) do
+  def handle_info({:srt_server_connect_request, address, stream_id, _request_id}, server) do
     Logger.info("Receiving new connection request with stream id: #{stream_id} from address: #{address}")
 
     {:ok, _handler} = ExLibSRT.Server.accept_awaiting_connect_request_with_handler(%ConnectionHandler{registry: ConnectionRegistry}, server)
@@ -17,7 +17,7 @@ defmodule Server do
   end
 
   @impl true
-  def handle_info({:srt_server_connect_request, address, stream_id}, state) do
+  def handle_info({:srt_server_connect_request, address, stream_id, _request_id}, state) do
     Logger.info(
       "Receiving new connection request with stream id: #{stream_id} from address: #{address}"
     )
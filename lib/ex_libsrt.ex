@@ -5,6 +5,7 @@ defmodule ExLibSRT do
   Available modules:
   * `ExLibSRT.Client` - SRT client implementation
   * `ExLibSRT.Server` - SRT server implementation
+  * `ExLibSRT.NativeMetrics` - metrics of the native layer
   """
 
   defmodule SocketStats do
@@ -66,7 +67,18 @@ defmodule ExLibSRT do
             pktReorderDistance: integer(),
             pktRcvBelated: integer(),
             pktSndDrop: integer(),
-            pktRcvDrop: integer()
+            pktRcvDrop: integer(),
+            msRTT: float(),
+            mbpsBandwidth: float(),
+            mbpsMaxBW: float(),
+            pktFlightSize: integer(),
+            pktCongestionWindow: integer(),
+            byteAvailSndBuf: integer(),
+            byteAvailRcvBuf: integer(),
+            msSndBuf: integer(),
+            msRcvBuf: integer(),
+            msSndTsbPdDelay: integer(),
+            msRcvTsbPdDelay: integer()
           }
     @enforce_keys [
       :msTimeStamp,
@@ -121,9 +133,214 @@ defmodule ExLibSRT do
       :pktReorderDistance,
       :pktRcvBelated,
       :pktSndDrop,
-      :pktRcvDrop
+      :pktRcvDrop,
+      :msRTT,
+      :mbpsBandwidth,
+      :mbpsMaxBW,
+      :pktFlightSize,
+      :pktCongestionWindow,
+      :byteAvailSndBuf,
+      :byteAvailRcvBuf,
+      :msSndBuf,
+      :msRcvBuf,
+      :msSndTsbPdDelay,
+      :msRcvTsbPdDelay
     ]
 
     defstruct @enforce_keys
   end
+
+  defmodule StatsSample do
+    @moduledoc """
+    Structure representing socket statistics gathered over a single sampling interval.
+
+    Counters are the changes of the corresponding `ExLibSRT.SocketStats` totals since the previous sample
+    (the first sample of a connection covers its whole lifetime), rates are computed from these counters
+    and `msInterval`, the actual length of the interval. `msRTT` and `mbpsBandwidth` are current estimates.
+    """
+    @type t :: %__MODULE__{
+            conn: integer(),
+            msInterval: non_neg_integer(),
+            pktSent: integer(),
+            pktRecv: integer(),
+            pktSndLoss: integer(),
+            pktRcvLoss: integer(),
+            pktRetrans: integer(),
+            pktSndDrop: integer(),
+            pktRcvDrop: integer(),
+            byteSent: non_neg_integer(),
+            byteRecv: non_neg_integer(),
+            pktSendRate: float(),
+            pktRecvRate: float(),
+            mbpsSendRate: float(),
+            mbpsRecvRate: float(),
+            msRTT: float(),
+            mbpsBandwidth: float()
+          }
+    @enforce_keys [
+      :conn,
+      :msInterval,
+      :pktSent,
+      :pktRecv,
+      :pktSndLoss,
+      :pktRcvLoss,
+      :pktRetrans,
+      :pktSndDrop,
+      :pktRcvDrop,
+      :byteSent,
+      :byteRecv,
+      :pktSendRate,
+      :pktRecvRate,
+      :mbpsSendRate,
+      :mbpsRecvRate,
+      :msRTT,
+      :mbpsBandwidth
+    ]
+
+    defstruct @enforce_keys
+  end
+
+  defmodule AggregateStats do
+    @moduledoc """
+    Structure representing statistics of all the connections of a server.
+
+    Counters and rates are summed over the connections. RTT, estimated bandwidth and receive buffer fill
+    (percentage of the receive buffer occupied by data waiting for delivery) are summarized with their minimum,
+    median, 99th percentile and maximum across the connections.
+    """
+    @type t :: %__MODULE__{
+            connections: non_neg_integer(),
+            pktSentTotal: integer(),
+            pktRecvTotal: integer(),
+            pktSndLossTotal: integer(),
+            pktRcvLossTotal: integer(),
+            pktRetransTotal: integer(),
+            pktSndDropTotal: integer(),
+            pktRcvDropTotal: integer(),
+            byteSentTotal: non_neg_integer(),
+            byteRecvTotal: non_neg_integer(),
+            byteRetransTotal: non_neg_integer(),
+            byteSndDropTotal: non_neg_integer(),
+            byteRcvDropTotal: non_neg_integer(),
+            mbpsSendRate: float(),
+            mbpsRecvRate: float(),
+            msRTTMin: float(),
+            msRTTP50: float(),
+            msRTTP99: float(),
+            msRTTMax: float(),
+            mbpsBandwidthMin: float(),
+            mbpsBandwidthP50: float(),
+            mbpsBandwidthP99: float(),
+            mbpsBandwidthMax: float(),
+            rcvBufFillMin: float(),
+            rcvBufFillP50: float(),
+            rcvBufFillP99: float(),
+            rcvBufFillMax: float()
+          }
+    @enforce_keys [
+      :connections,
+      :pktSentTotal,
+      :pktRecvTotal,
+      :pktSndLossTotal,
+      :pktRcvLossTotal,
+      :pktRetransTotal,
+      :pktSndDropTotal,
+      :pktRcvDropTotal,
+      :byteSentTotal,
+      :byteRecvTotal,
+      :byteRetransTotal,
+      :byteSndDropTotal,
+      :byteRcvDropTotal,
+      :mbpsSendRate,
+      :mbpsRecvRate,
+      :msRTTMin,
+      :msRTTP50,
+      :msRTTP99,
+      :msRTTMax,
+      :mbpsBandwidthMin,
+      :mbpsBandwidthP50,
+      :mbpsBandwidthP99,
+      :mbpsBandwidthMax,
+      :rcvBufFillMin,
+      :rcvBufFillP50,
+      :rcvBufFillP99,
+      :rcvBufFillMax
+    ]
+
+    defstruct @enforce_keys
+  end
+
+  defmodule TsStats do
+    @moduledoc """
+    Structure representing MPEG-TS health counters of a server connection, accumulated since
+    the connection got accepted.
+
+    * `packets` - inspected TS packets
+    * `forwarded_packets` - packets left after filtering the PIDs
+    * `sync_errors` - packets without the sync byte, together with payloads ending with a partial packet
+    * `cc_errors` - gaps in the continuity counters, not counting the signalled discontinuities
+    * `pcr_count` - number of the encountered PCRs
+    * `last_pcr` - the latest PCR in 27 MHz units and `last_pcr_pid` - the PID carrying it,
+      both `nil` until the first PCR
+    """
+    @type t :: %__MODULE__{
+            packets: non_neg_integer(),
+            forwarded_packets: non_neg_integer(),
+            sync_errors: non_neg_integer(),
+            cc_errors: non_neg_integer(),
+            pcr_count: non_neg_integer(),
+            last_pcr: non_neg_integer() | nil,
+            last_pcr_pid: non_neg_integer() | nil
+          }
+    @enforce_keys [
+      :packets,
+      :forwarded_packets,
+      :sync_errors,
+      :cc_errors,
+      :pcr_count,
+      :last_pcr,
+      :last_pcr_pid
+    ]
+
+    defstruct @enforce_keys
+
+    @doc false
+    def from_native({:ok, %__MODULE__{last_pcr: -1} = stats}),
+      do: {:ok, %__MODULE__{stats | last_pcr: nil, last_pcr_pid: nil}}
+
+    def from_native(result), do: result
+  end
+
+  defmodule LatencyHistograms do
+    @moduledoc """
+    Structure representing rolling histograms of a connection's RTT and of the delay of data waiting
+    in its receive buffer, both in milliseconds.
+
+    The connection gets sampled natively every 100 milliseconds, whether it carries any traffic or not.
+    The histograms cover samples from the last 5 to 10 seconds. Each bucket is represented by its
+    upper bound (inclusive) and the number of samples, the last bucket is unbounded.
+    """
+    @type bucket :: {upper_bound_ms :: float() | :infinity, count :: non_neg_integer()}
+
+    @type t :: %__MODULE__{
+            rtt: [bucket()],
+            rcv_buf_delay: [bucket()]
+          }
+    @enforce_keys [:rtt, :rcv_buf_delay]
+
+    defstruct @enforce_keys
+
+    @doc false
+    def from_native({:ok, bounds, rtt, rcv_buf_delay}) do
+      bounds = bounds ++ [:infinity]
+
+      {:ok,
+       %__MODULE__{
+         rtt: Enum.zip(bounds, rtt),
+         rcv_buf_delay: Enum.zip(bounds, rcv_buf_delay)
+       }}
+    end
+
+    def from_native({:error, _reason} = error), do: error
+  end
 end
@@ -10,8 +10,14 @@ defmodule ExLibSRT.Client do
   * `start_link/3` - starts a client connection to the server and links to current process
   * `start_link/4` - starts a client connection to the server with password authentication and links to current process
   * `start_link/5` - starts a client connection to the server with password authentication, sets SRT latency and links to current process
+  * `start_link/6` - same as `start_link/5`, additionally accepting `t:option/0` list
   * `stop/1` - stops the client connection
   * `send_data/2` - sends a packet through the client connection
+  * `send_data_batch/2` - enqueues many packets at once to be sent through the client connection
+  * `read_socket_stats/1` - reads statistics of the connection
+  * `read_latency_histograms/1` - reads RTT and receive buffer delay histograms of the connection
+  * `start_stats_sampler/3` - periodically sends statistics of the connection to a process
+  * `stop_stats_sampler/1` - stops sending the statistics
 
   ## Password Authentication
 
@@ -24,6 +30,21 @@ defmodule ExLibSRT.Client do
   * `t:srt_client_started/0`
   * `t:srt_client_disconnected/0`
   * `t:srt_client_error/0`
+  * `t:srt_client_ready/0` - only after a send got refused because of a full send queue
+
+  ## Backpressure
+
+  By default `send_data/2` waits for a free slot when the send queue is full. With the `non_blocking: true`
+  option it returns `{:error, :would_block}` immediately instead, and the process that started the client
+  receives `t:srt_client_ready/0` once the queue drains down to `:send_queue_low_watermark` messages.
+  The same notification follows `send_data_batch/2` calls that did not manage to enqueue all the packets.
+
+  ## Receiver mode
+
+  A client started with the `mode: :receiver` option pulls a stream from the server instead of sending one.
+  Received packets are delivered to the process that started the client as `t:srt_client_data_batch/0`
+  messages, each of them carrying all the packets that were available at once, up to the `:receive_batch` limits.
+  The packets are sub-binaries of larger buffers, see `ExLibSRT.Server` for when to copy them.
   """
 
   use Agent
@@ -34,6 +55,48 @@ defmodule ExLibSRT.Client do
   @type srt_client_started :: :srt_client_started
   @type srt_client_disconnected :: :srt_client_started
   @type srt_client_error :: {:srt_client_error, reason :: String.t()}
+  @type srt_client_ready :: :srt_client_ready
+  @type srt_client_data_batch :: {:srt_client_data_batch, packets :: [binary()]}
+  @type srt_client_stats :: {:srt_client_stats, ExLibSRT.StatsSample.t()}
+
+  @default_send_queue_capacity 256
+  @default_send_ttl_ms 200
+  @default_linger_ms 1_000
+  @default_batch_max_packets 64
+  @default_batch_max_bytes 65_536
+
+  @typedoc """
+  Additional client options.
+
+  * `:send_queue_capacity` - number of messages that can wait for being sent, `send_data/2` waits up to `:send_ttl_ms`
+    for a free slot while the queue is full and returns `{:error, "Send queue is full"}` afterwards,
+    defaults to `#{@default_send_queue_capacity}`. The waiting happens on a dirty IO scheduler.
+  * `:send_ttl_ms` - time after which a message that has not been sent yet gets dropped,
+    defaults to `#{@default_send_ttl_ms}`. Messages are never dropped in the file mode.
+  * `:non_blocking` - makes `send_data/2` return `{:error, :would_block}` instead of waiting when the send queue is full,
+    defaults to `false`
+  * `:send_queue_low_watermark` - number of queued messages at which `t:srt_client_ready/0` gets sent,
+    defaults to half of `:send_queue_capacity`
+  * `:linger_ms` - maximum time `stop/1` waits for the already enqueued data to be sent, stopping returns
+    as soon as everything is sent, defaults to `#{@default_linger_ms}`
+  * `:mode` - either `:sender` (default) or `:receiver`, see the "Receiver mode" section
+  * `:receive_batch` - limits of a single batch of received packets in the receiver mode,
+    `:max_packets` defaults to `#{@default_batch_max_packets}` and `:max_bytes` to `#{@default_batch_max_bytes}`
+
+  * `:socket_options` - list of `t:ExLibSRT.SocketOptions.option/0`, empty by default
+
+  Accepts `t:ExLibSRT.TransferOptions.option/0` as well, the server has to use the same transfer mode.
+  """
+  @type option ::
+          {:send_queue_capacity, pos_integer()}
+          | {:send_ttl_ms, pos_integer()}
+          | {:non_blocking, boolean()}
+          | {:send_queue_low_watermark, non_neg_integer()}
+          | {:linger_ms, non_neg_integer()}
+          | {:mode, :sender | :receiver}
+          | {:receive_batch, [max_packets: pos_integer(), max_bytes: pos_integer()]}
+          | {:socket_options, [ExLibSRT.SocketOptions.option()]}
+          | ExLibSRT.TransferOptions.option()
 
   @doc """
   Starts a new SRT connection to the target address and port and links to the current process.
@@ -48,13 +111,14 @@ defmodule ExLibSRT.Client do
           port :: non_neg_integer(),
           stream_id :: String.t(),
           password :: String.t(),
-          latency_ms :: integer()
+          latency_ms :: integer(),
+          opts :: [option()]
         ) ::
           {:ok, t()} | {:error, reason :: String.t(), error_code :: integer()}
-  def start_link(address, port, stream_id, password \\ "", latency_ms \\ -1) do
+  def start_link(address, port, stream_id, password \\ "", latency_ms \\ -1, opts \\ []) do
     with :ok <- validate_password(password),
          {:ok, client_ref} <-
-           ExLibSRT.Native.start_client(address, port, stream_id, password, latency_ms) do
+           start_native_client(address, port, stream_id, password, latency_ms, opts) do
       Agent.start_link(fn -> client_ref end)
     else
       {:error, reason, error_code} -> {:error, reason, error_code}
@@ -79,9 +143,19 @@ defmodule ExLibSRT.Client do
           password :: String.t()
         ) ::
           {:ok, t()} | {:error, reason :: String.t(), error_code :: integer()}
-  def start(address, port, stream_id, password \\ "") do
+  @spec start(
+          address :: String.t(),
+          port :: non_neg_integer(),
+          stream_id :: String.t(),
+          password :: String.t(),
+          latency_ms :: integer(),
+          opts :: [option()]
+        ) ::
+          {:ok, t()} | {:error, reason :: String.t(), error_code :: integer()}
+  def start(address, port, stream_id, password \\ "", latency_ms \\ -1, opts \\ []) do
     with :ok <- validate_password(password),
-         {:ok, client_ref} <- ExLibSRT.Native.start_client(address, port, stream_id, password, -1) do
+         {:ok, client_ref} <-
+           start_native_client(address, port, stream_id, password, latency_ms, opts) do
       Agent.start(fn -> client_ref end, name: {:global, client_ref})
     else
       {:error, reason, error_code} -> {:error, reason, error_code}
@@ -91,6 +165,9 @@ defmodule ExLibSRT.Client do
 
   @doc """
   Stops the active client connection.
+
+  Data that has already been enqueued gets sent before closing the connection, for no longer than
+  the `:linger_ms` option.
   """
   @spec stop(t()) :: :ok
   def stop(agent) do
@@ -101,12 +178,14 @@ defmodule ExLibSRT.Client do
 
   @doc """
   Sends data through the client connection.
+
+  The payload is not copied, the client keeps a reference to it until it gets sent.
+  Payloads larger than the limit of the transfer mode (see `ExLibSRT.TransferOptions`) are refused.
   """
-  @spec send_data(binary(), t()) :: :ok | {:error, :payload_too_large | (reason :: String.t())}
+  @spec send_data(binary(), t()) ::
+          :ok | {:error, :would_block | :payload_too_large | (reason :: String.t())}
   def send_data(payload, agent)
 
-  def send_data(payload, _agent) when byte_size(payload) > 1316, do: {:error, :payload_too_large}
-
   def send_data(payload, agent) do
     if Process.alive?(agent) do
       client_ref = Agent.get(agent, & &1)
@@ -116,6 +195,25 @@ defmodule ExLibSRT.Client do
     end
   end
 
+  @doc """
+  Enqueues a list of packets to be sent through the client connection.
+
+  Packets get enqueued in order until the send queue becomes full, the function never waits
+  for a free slot. Returns the number of accepted packets, the remaining ones are left to the caller
+  to be sent again later.
+  """
+  @spec send_data_batch([binary()], t()) ::
+          {:ok, accepted :: non_neg_integer()}
+          | {:error, :payload_too_large | (reason :: String.t())}
+  def send_data_batch(payloads, agent) do
+    if Process.alive?(agent) do
+      client_ref = Agent.get(agent, & &1)
+      ExLibSRT.Native.send_client_data_batch(payloads, client_ref)
+    else
+      {:error, "Client is not active"}
+    end
+  end
+
   @doc """
   Reads socket statistics.
   """
@@ -130,8 +228,139 @@ defmodule ExLibSRT.Client do
     end
   end
 
+  @doc """
+  Reads rolling histograms of the connection's RTT and receive buffer delay.
+  """
+  @spec read_latency_histograms(t()) ::
+          {:ok, ExLibSRT.LatencyHistograms.t()} | {:error, reason :: String.t()}
+  def read_latency_histograms(agent) do
+    if Process.alive?(agent) do
+      client_ref = Agent.get(agent, & &1)
+
+      client_ref
+      |> ExLibSRT.Native.read_client_latency_histograms()
+      |> ExLibSRT.LatencyHistograms.from_native()
+    else
+      {:error, "Client is not active"}
+    end
+  end
+
+  @doc """
+  Starts sending statistics of the connection to the subscriber as `t:srt_client_stats/0`
+  every `interval_ms`, without the need of polling `read_socket_stats/1`.
+
+  Starting the sampler again replaces the previous one.
+  """
+  @spec start_stats_sampler(pos_integer(), pid(), t()) :: :ok | {:error, reason :: String.t()}
+  def start_stats_sampler(interval_ms, subscriber, agent) do
+    if Process.alive?(agent) do
+      client_ref = Agent.get(agent, & &1)
+      ExLibSRT.Native.start_client_stats_sampler(interval_ms, subscriber, client_ref)
+    else
+      {:error, "Client is not active"}
+    end
+  end
+
+  @doc """
+  Stops sending statistics started with `start_stats_sampler/3`.
+  """
+  @spec stop_stats_sampler(t()) :: :ok | {:error, reason :: String.t()}
+  def stop_stats_sampler(agent) do
+    if Process.alive?(agent) do
+      client_ref = Agent.get(agent, & &1)
+      ExLibSRT.Native.stop_client_stats_sampler(client_ref)
+    else
+      {:error, "Client is not active"}
+    end
+  end
+
   # Private functions
 
+  defp start_native_client(address, port, stream_id, password, latency_ms, opts) do
+    with {:ok, send_queue_capacity} <-
+           integer_param(opts, :send_queue_capacity, @default_send_queue_capacity),
+         {:ok, send_ttl_ms} <- integer_param(opts, :send_ttl_ms, @default_send_ttl_ms),
+         {:ok, non_blocking} <- boolean_param(opts, :non_blocking, false),
+         {:ok, low_watermark} <-
+           low_watermark_param(opts, div(send_queue_capacity, 2), send_queue_capacity),
+         {:ok, linger_ms} <- linger_param(opts),
+         {:ok, receiver} <- mode_param(opts),
+         {:ok, {max_packets, max_bytes}} <- receive_batch_params(opts),
+         {:ok, {file_mode, payload_size, message_api, max_message_size}} <-
+           ExLibSRT.TransferOptions.native_params(opts),
+         {:ok, socket_options} <-
+           ExLibSRT.SocketOptions.encode(Keyword.get(opts, :socket_options, [])) do
+      ExLibSRT.Native.start_client(
+        address,
+        port,
+        stream_id,
+        password,
+        latency_ms,
+        send_queue_capacity,
+        send_ttl_ms,
+        non_blocking,
+        low_watermark,
+        linger_ms,
+        receiver,
+        max_packets,
+        max_bytes,
+        file_mode,
+        payload_size,
+        message_api,
+        max_message_size,
+        socket_options
+      )
+    end
+  end
+
+  defp mode_param(opts) do
+    case Keyword.get(opts, :mode, :sender) do
+      :sender -> {:ok, false}
+      :receiver -> {:ok, true}
+      _other -> {:error, "Invalid :mode option"}
+    end
+  end
+
+  defp receive_batch_params(opts) do
+    batch_opts = Keyword.get(opts, :receive_batch, [])
+
+    with true <- Keyword.keyword?(batch_opts),
+         {:ok, max_packets} <- integer_param(batch_opts, :max_packets, @default_batch_max_packets),
+         {:ok, max_bytes} <- integer_param(batch_opts, :max_bytes, @default_batch_max_bytes) do
+      {:ok, {max_packets, max_bytes}}
+    else
+      _error -> {:error, "Invalid receive batch options"}
+    end
+  end
+
+  defp boolean_param(opts, key, default) do
+    case Keyword.get(opts, key, default) do
+      value when is_boolean(value) -> {:ok, value}
+      _other -> {:error, "Invalid #{inspect(key)} option"}
+    end
+  end
+
+  defp linger_param(opts) do
+    case Keyword.get(opts, :linger_ms, @default_linger_ms) do
+      value when is_integer(value) and value >= 0 -> {:ok, value}
+      _other -> {:error, "Invalid :linger_ms option"}
+    end
+  end
+
+  defp low_watermark_param(opts, default, send_queue_capacity) do
+    case Keyword.get(opts, :send_queue_low_watermark, default) do
+      value when is_integer(value) and value >= 0 and value < send_queue_capacity -> {:ok, value}
+      _other -> {:error, "Invalid :send_queue_low_watermark option"}
+    end
+  end
+
+  defp integer_param(opts, key, default) do
+    case Keyword.get(opts, key, default) do
+      value when is_integer(value) and value > 0 -> {:ok, value}
+      _other -> {:error, "Invalid #{inspect(key)} option"}
+    end
+  end
+
   @spec validate_password(String.t()) :: :ok | {:error, String.t()}
   defp validate_password(""), do: :ok
 
@@ -71,6 +71,24 @@ defmodule ExLibSRT.Connection do
     end
   end
 
+  @impl true
+  def handle_info({:srt_data_batch, _conn_id, packets}, state) do
+    packets
+    |> Enum.reduce_while({:ok, state.handler_state}, fn data, {:ok, handler_state} ->
+      case state.handler.handle_data(data, handler_state) do
+        {:ok, handler_state} -> {:cont, {:ok, handler_state}}
+        :stop -> {:halt, :stop}
+      end
+    end)
+    |> case do
+      {:ok, handler_state} ->
+        {:noreply, %{state | handler_state: handler_state}}
+
+      :stop ->
+        {:stop, :normal, state}
+    end
+  end
+
   @impl true
   def handle_info({:srt_server_conn, conn, stream_id}, state) do
     case state.handler.handle_connected(conn, stream_id, state.handler_state) do
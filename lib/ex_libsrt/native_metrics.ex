@@ -0,0 +1,80 @@
+defmodule ExLibSRT.NativeMetrics do
+  @moduledoc """
+  Metrics of the native layer itself, shared by all servers and clients of the node.
+
+  They help to tell apart problems of the SRT connections from bottlenecks of the binding:
+  * `send_failures` - messages that could not be delivered, as their receiving process was gone
+  * `epoll_wakeups` - server worker wakeups with at least one socket event, the wakeup rate is
+    the difference between two reads divided by the time between them
+  * `data_callback_us` - time spent delivering received data to the BEAM by the server, in microseconds,
+    sampled from every 64th packet, or from every batch when the server batches its deliveries
+  * `connection_lookup_us` - time server workers spent resolving the connection of a socket event,
+    in microseconds, sampled from every 64th lookup
+  * `client_send_queue_depth` - number of messages in a client's send queue right after enqueueing one
+  * `client_send_queue_time_us` - time messages spent in a client's send queue, in microseconds,
+    sampled from every 64th message
+  * `packets_per_wakeup` - number of packets received by a server worker per wakeup
+
+  All the values are accumulated since the native library got loaded.
+  """
+
+  defmodule Histogram do
+    @moduledoc """
+    Summary of recorded values.
+
+    Values are counted in power of two buckets, so the percentiles are upper bounds
+    of the buckets holding them.
+    """
+    @type t :: %__MODULE__{
+            count: non_neg_integer(),
+            sum: non_neg_integer(),
+            max: non_neg_integer(),
+            p50: non_neg_integer(),
+            p99: non_neg_integer()
+          }
+    @enforce_keys [:count, :sum, :max, :p50, :p99]
+
+    defstruct @enforce_keys
+  end
+
+  @type t :: %__MODULE__{
+          send_failures: non_neg_integer(),
+          epoll_wakeups: non_neg_integer(),
+          data_callback_us: Histogram.t(),
+          connection_lookup_us: Histogram.t(),
+          client_send_queue_depth: Histogram.t(),
+          client_send_queue_time_us: Histogram.t(),
+          packets_per_wakeup: Histogram.t()
+        }
+  @enforce_keys [
+    :send_failures,
+    :epoll_wakeups,
+    :data_callback_us,
+    :connection_lookup_us,
+    :client_send_queue_depth,
+    :client_send_queue_time_us,
+    :packets_per_wakeup
+  ]
+
+  defstruct @enforce_keys
+
+  @doc """
+  Reads the current metrics.
+  """
+  @spec read() :: t()
+  def read() do
+    {:ok, send_failures, epoll_wakeups, data_callback_us, connection_lookup_us,
+     client_send_queue_depth, client_send_queue_time_us,
+     packets_per_wakeup} = ExLibSRT.Native.read_native_metrics()
+
+    %__MODULE__{
+      send_failures: send_failures,
+      epoll_wakeups: epoll_wakeups,
+      data_callback_us: data_callback_us,
+      connection_lookup_us: connection_lookup_us,
+      client_send_queue_depth: client_send_queue_depth,
+      client_send_queue_time_us: client_send_queue_time_us,
+      packets_per_wakeup: packets_per_wakeup
+    }
+  end
+end
@@ -7,13 +7,29 @@ defmodule ExLibSRT.Server do
 
   * `start/2` - starts the server
   * `start/3` - starts the server with password authentication
+  * `start/5` - starts the server with password authentication, SRT latency and additional server options
   * `start_link/2` - starts the server and links to current process
   * `start_link/3` - starts the server with password authentication and links to current process
   * `start_link/4` - starts the server with password authentication, sets SRT latency and links to current process
+  * `start_link/5` - same as `start_link/4` but accepts additional server options (see `t:option/0`)
   * `stop/1` - stops the server
-  * `accept_awaiting_connect_request/1` - accepts next incoming connection
-  * `reject_awaiting_connect_request/1` - rejects next incoming connection
+  * `accept_awaiting_connect_request/1` - accepts the awaiting connect request, whatever its id
+  * `accept_awaiting_connect_request/2` - accepts the connect request with given id
+  * `accept_awaiting_connect_request/3` - accepts the connect request with given id, overriding the server's socket options
+  * `reject_awaiting_connect_request/1` - rejects the awaiting connect request, whatever its id
+  * `reject_awaiting_connect_request/2` - rejects the connect request with given id
   * `close_server_connection/2` - stops server's connection to given client
+  * `send_data/3` - sends a packet to one or many connected clients
+  * `add_relay_route/3` - forwards data of connections with given stream id to a client natively
+  * `remove_relay_route/3` - stops forwarding data to the client
+  * `set_admission_rules/2` - installs rules deciding about connect requests natively
+  * `clear_admission_rules/1` - removes the admission rules
+  * `read_socket_stats/2` - reads statistics of a single connection
+  * `read_aggregate_stats/1` - reads statistics summarized across all connections
+  * `read_latency_histograms/2` - reads RTT and receive buffer delay histograms of a connection
+  * `read_ts_stats/2` - reads MPEG-TS health counters of a connection
+  * `start_stats_sampler/3` - periodically sends statistics of all connections to a process
+  * `stop_stats_sampler/1` - stops sending the statistics
 
   ## Password Authentication
 
@@ -27,38 +43,171 @@ defmodule ExLibSRT.Server do
   * `t:srt_server_conn_closed/0` - a client connection has been closed
   * `t:srt_server_error/0` - server has encountered an error
   * `t:srt_data/0` - server has received new data on a client connection
+  * `t:srt_data_batch/0` - server has received multiple packets on a client connection (only when `:receive_batch` is enabled)
   * `t:srt_server_connect_request/0` - server has triggered a new connection request
-    (see `accept_awaiting_connect_request/1` and `reject_awaiting_connect_request/1` for answering the request)
+    (see `accept_awaiting_connect_request/2` and `reject_awaiting_connect_request/2` for answering the request)
 
   ### Accepting connections
   Each SRT connection can carry a `streamid` string which can be used for identifying the stream.
 
   To support accepting/rejecting the connection a server sends `t:srt_server_connect_request/0` event.
-  THe process that started the server is then obliged to either call  `accept_awaiting_connect_request/1` or `reject_awaiting_connect_request/1`.
-  Not responding in time will result in server's rejecting the connection.
+  THe process that started the server is then obliged to either call  `accept_awaiting_connect_request/2` or `reject_awaiting_connect_request/2`
+  with the request id carried by the event. Not responding in time (see `:connect_request_timeout_ms` option) will result in server's rejecting the connection.
 
   When user rejects the stream, the server respons with `1403` rejection code (SRT wise). While not being to accept in time
   results in `1504` (not that the codes respectively are the same of HTTP 403 forbidden and 504 gateway timeout).
+  A connection whose socket options (see `ExLibSRT.SocketOptions`) can't be applied gets rejected with `1500`.
+
+  ### Admission rules
+  Answering each connect request from Elixir costs a round trip between the native layer and the BEAM
+  for every handshake. `set_admission_rules/2` installs a rule table (see `t:admission_rule/0`) that gets evaluated
+  directly inside the listener. A request decided by the rules never results in `t:srt_server_connect_request/0`
+  being sent, only the requests which are not matched by any rule fall back to the regular flow.
+
+  Connections accepted by the rules get delivered to the process that has started the server.
+  The rules can be replaced at any time.
+
+  ### Received data
+  To avoid per-packet allocations and copies, the server receives data directly into large
+  shared buffers and each delivered packet references a part of such a buffer. A buffer gets freed
+  only once all the packets referencing it are garbage collected, so packets that are meant to be
+  kept around for a long time should be copied with `:binary.copy/1`.
+
+  ### Batched receiving
+  By default every received packet gets delivered as a separate `t:srt_data/0` message.
+  With high bitrate streams this results in thousands of messages per second per connection.
+
+  Passing the `:receive_batch` option makes the server drain each readable socket
+  until it would block or until one of the batch limits gets reached. All the packets read
+  during a single drain are then delivered in order as one `t:srt_data_batch/0` message.
+
+  ### MPEG-TS inspection
+  Streams carrying MPEG-TS can be inspected natively with the `:ts_inspection` option, before the data
+  reaches the BEAM. Every received payload gets split into 188 byte TS packets, which are checked
+  for the sync byte and for gaps of their PID's continuity counter, while PCRs get extracted.
+  Only the packets of the PIDs given with `pids: [...]` get delivered, the others never leave the native layer,
+  just as the packets without the sync byte. Payloads left without any packets are not delivered at all.
+  Without `pids: [...]` the payloads get delivered intact, the broken packets only get counted.
+
+  The health counters of each connection can be read with `read_ts_stats/2`.
+
+  ### Statistics sampling
+  Polling `read_socket_stats/2` for every connection costs a NIF call per connection each time.
+  `start_stats_sampler/3` instead makes the server read statistics of all active connections natively
+  every interval and send them to the subscriber as a single `t:srt_server_stats/0` message.
 
   > #### Response timeout {: .warning}
   >
   > It is very important to answer the connection request as fast as possible.
   > Due to how `libsrt` works, while the server waits for the response it blocks the receiving thread
-  > and potentially interrupts other ongoing connections.
+  > and potentially interrupts other ongoing connections. For the same reason only a single connect request
+  > is ever awaiting an answer, the next handshake is not processed before the previous request gets answered
+  > or times out. Lowering the `:connect_request_timeout_ms` option bounds how long a single unanswered request
+  > can hold off other handshakes, while `set_admission_rules/2` decides about requests without waiting at all.
+  >
+  > The request id only guards against answers that come too late, an answer carrying the id of a request
+  > that is not awaiting anymore results in `{:error, "Connect request not found"}`.
   """
 
   use Agent
 
+  # native layer answers the awaiting request whatever its id when given a negative id
+  @any_connect_request -1
+
+  @default_batch_max_packets 64
+  @default_batch_max_bytes 65_536
+  @default_batch_max_time_us 1_000
+  @default_listen_backlog 5
+  @default_connect_request_timeout_ms 1_000
+  @default_send_queue_capacity 256
+
   @type t :: pid()
 
   @type connection_id :: non_neg_integer()
 
+  @typedoc """
+  Id of a connect request, once the request gets accepted it becomes the id of the established connection.
+  """
+  @type connect_request_id :: integer()
+
   @type srt_server_conn :: {:srt_server_conn, connection_id(), stream_id :: String.t()}
   @type srt_server_conn_closed :: {:srt_server_conn_closed, connection_id()}
   @type srt_server_error :: {:srt_server_error, connection_id(), error :: String.t()}
   @type srt_data :: {:srt_data, connection_id(), data :: binary()}
+  @type srt_data_batch :: {:srt_data_batch, connection_id(), packets :: [binary()]}
+  @type srt_server_stats :: {:srt_server_stats, [ExLibSRT.StatsSample.t()]}
   @type srt_server_connect_request ::
-          {:srt_server_connect_request, address :: String.t(), stream_id :: String.t()}
+          {:srt_server_connect_request, address :: String.t(), stream_id :: String.t(),
+           connect_request_id()}
+
+  @typedoc """
+  Options for limiting a single socket drain in the batched receiving mode.
+
+  * `:max_packets` - maximum number of packets delivered in a single batch, defaults to `#{@default_batch_max_packets}`
+  * `:max_bytes` - maximum number of bytes delivered in a single batch, defaults to `#{@default_batch_max_bytes}`
+  * `:max_time_us` - time budget of a single drain in microseconds, `0` means no limit, defaults to `#{@default_batch_max_time_us}`
+  """
+  @type receive_batch_option ::
+          {:max_packets, pos_integer()}
+          | {:max_bytes, pos_integer()}
+          | {:max_time_us, non_neg_integer()}
+
+  @typedoc """
+  Additional server options.
+
+  * `:receive_batch` - enables the batched receiving mode when set to `true` or to a list of `t:receive_batch_option/0`,
+    disabled by default
+  * `:workers` - number of threads handling accepted connections, each connection gets assigned
+    to the least loaded one, defaults to `1`
+  * `:listen_backlog` - maximum number of pending connections on the listening socket, defaults to `#{@default_listen_backlog}`
+  * `:connect_request_timeout_ms` - time after which an unanswered connect request gets rejected,
+    defaults to `#{@default_connect_request_timeout_ms}`
+  * `:send_queue_capacity` - maximum number of packets waiting for being sent to a single connection,
+    defaults to `#{@default_send_queue_capacity}`
+
+  * `:socket_options` - list of `t:ExLibSRT.SocketOptions.option/0` applied to every accepted connection,
+    empty by default
+  * `:ts_inspection` - enables the MPEG-TS inspection when set to `true` or to `[pids: pids]`
+    limiting the delivered packets to the given PIDs, disabled by default
+
+  Accepts `t:ExLibSRT.TransferOptions.option/0` as well, which apply to all the accepted connections.
+  """
+  @type option ::
+          {:receive_batch, boolean() | [receive_batch_option()]}
+          | {:workers, pos_integer()}
+          | {:listen_backlog, pos_integer()}
+          | {:connect_request_timeout_ms, pos_integer()}
+          | {:send_queue_capacity, pos_integer()}
+          | {:socket_options, [ExLibSRT.SocketOptions.option()]}
+          | {:ts_inspection, boolean() | [pids: [non_neg_integer()]]}
+          | ExLibSRT.TransferOptions.option()
+
+  @typedoc """
+  Matcher of a connect request's stream id.
+
+  * `{:exact, stream_id}` - matches the given stream id only
+  * `{:prefix, prefix}` - matches stream ids starting with the given prefix
+  * `{:access_control, keys}` - matches stream ids following the SRT access control syntax (`#!::r=live/cam1,m=publish`)
+    that contain all of the given keys with equal values, e.g. `%{"m" => "publish"}`
+  """
+  @type stream_matcher ::
+          {:exact, String.t()}
+          | {:prefix, String.t()}
+          | {:access_control, %{String.t() => String.t()}}
+
+  @typedoc """
+  Admission rules, evaluated in the following order:
+
+  * `:max_connections` - requests exceeding the number of active connections get rejected with `1402` code, `0` means no limit (default)
+  * `:deny_peers` - requests coming from any of the given networks (e.g. `"10.0.0.0/8"`) get rejected with `1403` code
+  * `:allow_peers` - when not empty, requests coming from outside of the given networks get rejected with `1403` code
+  * `:stream_rules` - the first stream rule matching the request's stream id either accepts it or rejects it with `1403` code
+  """
+  @type admission_rule ::
+          {:max_connections, non_neg_integer()}
+          | {:deny_peers, [String.t()]}
+          | {:allow_peers, [String.t()]}
+          | {:stream_rules, [{:accept | :reject, stream_matcher()}]}
 
   @doc """
   Starts a new SRT server binding to given address and port and links to current process.
@@ -74,12 +223,13 @@ defmodule ExLibSRT.Server do
           address :: String.t(),
           port :: non_neg_integer(),
           password :: String.t(),
-          latency_ms :: integer()
+          latency_ms :: integer(),
+          opts :: [option()]
         ) ::
           {:ok, t()} | {:error, reason :: String.t(), error_code :: integer()}
-  def start_link(address, port, password \\ "", latency_ms \\ -1) do
+  def start_link(address, port, password \\ "", latency_ms \\ -1, opts \\ []) do
     with :ok <- validate_password(password),
-         {:ok, server_ref} <- ExLibSRT.Native.start_server(address, port, password, latency_ms) do
+         {:ok, server_ref} <- start_native_server(address, port, password, latency_ms, opts) do
       Agent.start_link(fn -> server_ref end)
     else
       {:error, reason, error_code} -> {:error, reason, error_code}
@@ -101,9 +251,17 @@ defmodule ExLibSRT.Server do
           {:ok, t()} | {:error, reason :: String.t(), error_code :: integer()}
   @spec start(address :: String.t(), port :: non_neg_integer(), password :: String.t()) ::
           {:ok, t()} | {:error, reason :: String.t(), error_code :: integer()}
-  def start(address, port, password \\ "") do
+  @spec start(
+          address :: String.t(),
+          port :: non_neg_integer(),
+          password :: String.t(),
+          latency_ms :: integer(),
+          opts :: [option()]
+        ) ::
+          {:ok, t()} | {:error, reason :: String.t(), error_code :: integer()}
+  def start(address, port, password \\ "", latency_ms \\ -1, opts \\ []) do
     with :ok <- validate_password(password),
-         {:ok, server_ref} <- ExLibSRT.Native.start_server(address, port, password, -1) do
+         {:ok, server_ref} <- start_native_server(address, port, password, latency_ms, opts) do
       Agent.start(fn -> server_ref end, name: {:global, server_ref})
     else
       {:error, reason, error_code} -> {:error, reason, error_code}
@@ -125,28 +283,79 @@ defmodule ExLibSRT.Server do
   end
 
   @doc """
-  Acccepts the currently awaiting connection request.
+  Acccepts the awaiting connection request, whatever its id.
   """
   @spec accept_awaiting_connect_request(t()) :: :ok | {:error, reason :: String.t()}
   def accept_awaiting_connect_request(agent) do
-    if Process.alive?(agent) do
+    accept_awaiting_connect_request(@any_connect_request, agent)
+  end
+
+  @doc """
+  Acccepts the awaiting connection request with given id.
+  """
+  @spec accept_awaiting_connect_request(connect_request_id(), t()) ::
+          :ok | {:error, reason :: String.t()}
+  def accept_awaiting_connect_request(request_id, agent) do
+    accept_awaiting_connect_request(request_id, [], agent)
+  end
+
+  @doc """
+  Acccepts the awaiting connection request with given id, the given socket options take precedence
+  over the `:socket_options` of the server for this connection only.
+
+  `:mss`, `:rcvbuf` and `:sndbuf` are shared by all the connections of the server and can't be overridden.
+  """
+  @spec accept_awaiting_connect_request(
+          connect_request_id(),
+          [ExLibSRT.SocketOptions.option()],
+          t()
+        ) :: :ok | {:error, reason :: String.t()}
+  def accept_awaiting_connect_request(request_id, socket_options, agent) do
+    with true <- Process.alive?(agent),
+         {:ok, socket_options} <- ExLibSRT.SocketOptions.encode(socket_options) do
       server_ref = Agent.get(agent, & &1)
-      ExLibSRT.Native.accept_awaiting_connect_request(self(), server_ref)
+
+      ExLibSRT.Native.accept_awaiting_connect_request(
+        request_id,
+        self(),
+        socket_options,
+        server_ref
+      )
     else
-      {:error, "Server is not active"}
+      false -> {:error, "Server is not active"}
+      {:error, _reason} = error -> error
     end
   end
 
   @doc """
-  Acccepts the currently awaiting connection request and starts a separate connection process
+  Acccepts the awaiting connection request, whatever its id, and starts a separate connection process
   """
   @spec accept_awaiting_connect_request_with_handler(ExLibSRT.Connection.Handler.t(), t()) ::
           {:ok, ExLibSRT.Connection.t()} | {:error, reason :: any()}
   def accept_awaiting_connect_request_with_handler(handler, agent) do
+    accept_awaiting_connect_request_with_handler(@any_connect_request, handler, agent)
+  end
+
+  @doc """
+  Acccepts the awaiting connection request with given id and starts a separate connection process
+  """
+  @spec accept_awaiting_connect_request_with_handler(
+          connect_request_id(),
+          ExLibSRT.Connection.Handler.t(),
+          t()
+        ) ::
+          {:ok, ExLibSRT.Connection.t()} | {:error, reason :: any()}
+  def accept_awaiting_connect_request_with_handler(request_id, handler, agent) do
     with true <- Process.alive?(agent),
          server_ref = Agent.get(agent, & &1),
          {:ok, handler} <- ExLibSRT.Connection.start(handler),
-         :ok <- ExLibSRT.Native.accept_awaiting_connect_request(handler, server_ref) do
+         :ok <-
+           ExLibSRT.Native.accept_awaiting_connect_request(
+             request_id,
+             handler,
+             %ExLibSRT.SocketOptions{},
+             server_ref
+           ) do
       {:ok, handler}
     else
       false ->
@@ -159,13 +368,63 @@ defmodule ExLibSRT.Server do
   end
 
   @doc """
-  Rejects the currently awaiting connection request.
+  Rejects the awaiting connection request, whatever its id.
   """
   @spec reject_awaiting_connect_request(t()) :: :ok | {:error, reason :: String.t()}
   def reject_awaiting_connect_request(agent) do
+    reject_awaiting_connect_request(@any_connect_request, agent)
+  end
+
+  @doc """
+  Rejects the awaiting connection request with given id.
+  """
+  @spec reject_awaiting_connect_request(connect_request_id(), t()) ::
+          :ok | {:error, reason :: String.t()}
+  def reject_awaiting_connect_request(request_id, agent) do
     if Process.alive?(agent) do
       server_ref = Agent.get(agent, & &1)
-      ExLibSRT.Native.reject_awaiting_connect_request(server_ref)
+      ExLibSRT.Native.reject_awaiting_connect_request(request_id, server_ref)
+    else
+      {:error, "Server is not active"}
+    end
+  end
+
+  @doc """
+  Installs admission rules evaluated natively for every incoming connect request.
+
+  Replaces previously installed rules, see `t:admission_rule/0` for how the rules get evaluated.
+  """
+  @spec set_admission_rules([admission_rule()], t()) :: :ok | {:error, reason :: String.t()}
+  def set_admission_rules(rules, agent) do
+    with true <- Process.alive?(agent),
+         {:ok, stream_rules} <- encode_stream_rules(Keyword.get(rules, :stream_rules, [])) do
+      server_ref = Agent.get(agent, & &1)
+
+      {actions, matches, patterns} = stream_rules
+
+      ExLibSRT.Native.set_server_admission_rules(
+        Keyword.get(rules, :max_connections, 0),
+        Keyword.get(rules, :allow_peers, []),
+        Keyword.get(rules, :deny_peers, []),
+        actions,
+        matches,
+        patterns,
+        server_ref
+      )
+    else
+      false -> {:error, "Server is not active"}
+      {:error, _reason} = error -> error
+    end
+  end
+
+  @doc """
+  Removes admission rules, all connect requests get passed to the process that has started the server again.
+  """
+  @spec clear_admission_rules(t()) :: :ok | {:error, reason :: String.t()}
+  def clear_admission_rules(agent) do
+    if Process.alive?(agent) do
+      server_ref = Agent.get(agent, & &1)
+      ExLibSRT.Native.clear_server_admission_rules(server_ref)
     else
       {:error, "Server is not active"}
     end
@@ -173,6 +432,9 @@ defmodule ExLibSRT.Server do
 
   @doc """
   Closes the connection to the given client.
+
+  The connection gets closed asynchronously by the worker handling it, which checks for such requests
+  every 10 milliseconds, `t:srt_server_conn_closed/0` is sent once it is closed.
   """
   @spec close_server_connection(connection_id(), t()) :: :ok | {:error, reason :: String.t()}
   def close_server_connection(connection_id, agent) do
@@ -184,6 +446,62 @@ defmodule ExLibSRT.Server do
     end
   end
 
+  @doc """
+  Sends a packet to the given connection or to each of the given connections.
+
+  The payload is not copied, all the connections share a reference to it until it gets sent.
+  Payloads larger than the limit of the transfer mode (see `ExLibSRT.TransferOptions`) are refused.
+  Returns the connections the packet could not be enqueued for, either because they
+  are no longer connected or because their send queue is full.
+  """
+  @spec send_data(binary(), connection_id() | [connection_id()], t()) ::
+          {:ok, failed :: [connection_id()]}
+          | {:error, :payload_too_large | (reason :: String.t())}
+  def send_data(payload, connection_ids, agent)
+
+  def send_data(payload, connection_id, agent) when is_integer(connection_id),
+    do: send_data(payload, [connection_id], agent)
+
+  def send_data(payload, connection_ids, agent) do
+    if Process.alive?(agent) do
+      server_ref = Agent.get(agent, & &1)
+      ExLibSRT.Native.send_server_data(payload, connection_ids, server_ref)
+    else
+      {:error, "Server is not active"}
+    end
+  end
+
+  @doc """
+  Relays data received from connections with the given stream id to the given client.
+
+  Packets get forwarded natively, right after being received, without passing through the BEAM.
+  Relayed connections stop delivering their data to the owner, while connection events keep being sent.
+  The route applies to already active connections as well as to future ones, many clients can be
+  added to a single route.
+
+  Relayed packets skip the client's send queue, packets that can't be sent right away get dropped.
+  Only clients in the sender mode can be relay targets, others are refused with an error.
+  """
+  @spec add_relay_route(String.t(), ExLibSRT.Client.t(), t()) :: :ok | {:error, reason :: String.t()}
+  def add_relay_route(stream_id, client, agent) do
+    with {:ok, server_ref} <- get_ref(agent, "Server is not active"),
+         {:ok, client_ref} <- get_ref(client, "Client is not active") do
+      ExLibSRT.Native.add_server_relay_route(stream_id, client_ref, server_ref)
+    end
+  end
+
+  @doc """
+  Stops relaying data of connections with the given stream id to the given client.
+  """
+  @spec remove_relay_route(String.t(), ExLibSRT.Client.t(), t()) ::
+          :ok | {:error, reason :: String.t()}
+  def remove_relay_route(stream_id, client, agent) do
+    with {:ok, server_ref} <- get_ref(agent, "Server is not active"),
+         {:ok, client_ref} <- get_ref(client, "Client is not active") do
+      ExLibSRT.Native.remove_server_relay_route(stream_id, client_ref, server_ref)
+    end
+  end
+
   @doc """
   Reads socket statistics.
   """
@@ -198,8 +516,187 @@ defmodule ExLibSRT.Server do
     end
   end
 
+  @doc """
+  Reads rolling histograms of the connection's RTT and receive buffer delay.
+  """
+  @spec read_latency_histograms(connection_id(), t()) ::
+          {:ok, ExLibSRT.LatencyHistograms.t()} | {:error, reason :: String.t()}
+  def read_latency_histograms(connection_id, agent) do
+    with {:ok, server_ref} <- get_ref(agent, "Server is not active") do
+      connection_id
+      |> ExLibSRT.Native.read_server_latency_histograms(server_ref)
+      |> ExLibSRT.LatencyHistograms.from_native()
+    end
+  end
+
+  @doc """
+  Reads MPEG-TS health counters of the connection, available only with the `:ts_inspection` option.
+  """
+  @spec read_ts_stats(connection_id(), t()) ::
+          {:ok, ExLibSRT.TsStats.t()} | {:error, reason :: String.t()}
+  def read_ts_stats(connection_id, agent) do
+    with {:ok, server_ref} <- get_ref(agent, "Server is not active") do
+      connection_id
+      |> ExLibSRT.Native.read_server_ts_stats(server_ref)
+      |> ExLibSRT.TsStats.from_native()
+    end
+  end
+
+  @doc """
+  Reads statistics of all active connections at once, summed up or summarized
+  with their distribution, see `ExLibSRT.AggregateStats`.
+  """
+  @spec read_aggregate_stats(t()) ::
+          {:ok, ExLibSRT.AggregateStats.t()} | {:error, reason :: String.t()}
+  def read_aggregate_stats(agent) do
+    with {:ok, server_ref} <- get_ref(agent, "Server is not active") do
+      ExLibSRT.Native.read_server_aggregate_stats(server_ref)
+    end
+  end
+
+  @doc """
+  Starts sending statistics of all active connections to the subscriber every `interval_ms`.
+
+  Each interval results in a single `t:srt_server_stats/0` message, which is skipped when there are
+  no active connections. Starting the sampler again replaces the previous one.
+  """
+  @spec start_stats_sampler(pos_integer(), pid(), t()) :: :ok | {:error, reason :: String.t()}
+  def start_stats_sampler(interval_ms, subscriber, agent) do
+    with {:ok, server_ref} <- get_ref(agent, "Server is not active") do
+      ExLibSRT.Native.start_server_stats_sampler(interval_ms, subscriber, server_ref)
+    end
+  end
+
+  @doc """
+  Stops sending statistics started with `start_stats_sampler/3`.
+  """
+  @spec stop_stats_sampler(t()) :: :ok | {:error, reason :: String.t()}
+  def stop_stats_sampler(agent) do
+    with {:ok, server_ref} <- get_ref(agent, "Server is not active") do
+      ExLibSRT.Native.stop_server_stats_sampler(server_ref)
+    end
+  end
+
   # Private functions
 
+  defp get_ref(agent, error) do
+    if Process.alive?(agent) do
+      {:ok, Agent.get(agent, & &1)}
+    else
+      {:error, error}
+    end
+  end
+
+  defp start_native_server(address, port, password, latency_ms, opts) do
+    with {:ok, {max_packets, max_bytes, max_time_us}} <- receive_batch_params(opts),
+         {:ok, workers} <- integer_param(opts, :workers, 1),
+         {:ok, listen_backlog} <- integer_param(opts, :listen_backlog, @default_listen_backlog),
+         {:ok, connect_request_timeout_ms} <-
+           integer_param(opts, :connect_request_timeout_ms, @default_connect_request_timeout_ms),
+         {:ok, send_queue_capacity} <-
+           integer_param(opts, :send_queue_capacity, @default_send_queue_capacity),
+         {:ok, {file_mode, payload_size, message_api, max_message_size}} <-
+           ExLibSRT.TransferOptions.native_params(opts),
+         {:ok, socket_options} <-
+           ExLibSRT.SocketOptions.encode(Keyword.get(opts, :socket_options, [])),
+         {:ok, {ts_inspection, ts_pids}} <- ts_inspection_params(opts) do
+      ExLibSRT.Native.start_server(
+        address,
+        port,
+        password,
+        latency_ms,
+        max_packets,
+        max_bytes,
+        max_time_us,
+        workers,
+        listen_backlog,
+        connect_request_timeout_ms,
+        send_queue_capacity,
+        file_mode,
+        payload_size,
+        message_api,
+        max_message_size,
+        socket_options,
+        ts_inspection,
+        ts_pids
+      )
+    end
+  end
+
+  defp encode_stream_rules(stream_rules) do
+    stream_rules
+    |> Enum.reduce_while({[], [], []}, fn
+      {action, {match, pattern}}, {actions, matches, patterns}
+      when action in [:accept, :reject] and match in [:exact, :prefix] and is_binary(pattern) ->
+        {:cont, {[action | actions], [match | matches], [pattern | patterns]}}
+
+      {action, {:access_control, keys}}, {actions, matches, patterns}
+      when action in [:accept, :reject] and (is_map(keys) or is_list(keys)) ->
+        pattern = Enum.map_join(keys, ",", fn {key, value} -> "#{key}=#{value}" end)
+        {:cont, {[action | actions], [:access_control | matches], [pattern | patterns]}}
+
+      rule, _acc ->
+        {:halt, {:error, "Invalid stream rule: #{inspect(rule)}"}}
+    end)
+    |> case do
+      {:error, _reason} = error ->
+        error
+
+      {actions, matches, patterns} ->
+        {:ok, {Enum.reverse(actions), Enum.reverse(matches), Enum.reverse(patterns)}}
+    end
+  end
+
+  defp integer_param(opts, key, default) do
+    case Keyword.get(opts, key, default) do
+      value when is_integer(value) and value > 0 -> {:ok, value}
+      _other -> {:error, "Invalid #{inspect(key)} option"}
+    end
+  end
+
+  defp receive_batch_params(opts) do
+    case Keyword.get(opts, :receive_batch, false) do
+      false ->
+        {:ok, {0, 0, 0}}
+
+      true ->
+        receive_batch_params(receive_batch: [])
+
+      batch_opts when is_list(batch_opts) ->
+        max_packets = Keyword.get(batch_opts, :max_packets, @default_batch_max_packets)
+        max_bytes = Keyword.get(batch_opts, :max_bytes, @default_batch_max_bytes)
+        max_time_us = Keyword.get(batch_opts, :max_time_us, @default_batch_max_time_us)
+
+        if is_integer(max_packets) and max_packets > 0 and is_integer(max_bytes) and
+             max_bytes > 0 and is_integer(max_time_us) and max_time_us >= 0 do
+          {:ok, {max_packets, max_bytes, max_time_us}}
+        else
+          {:error, "Invalid receive batch options"}
+        end
+
+      _other ->
+        {:error, "Invalid receive batch options"}
+    end
+  end
+
+  defp ts_inspection_params(opts) do
+    case Keyword.get(opts, :ts_inspection, false) do
+      false ->
+        {:ok, {false, []}}
+
+      true ->
+        {:ok, {true, []}}
+
+      [pids: pids] when is_list(pids) ->
+        if Enum.all?(pids, &is_integer/1),
+          do: {:ok, {true, pids}},
+          else: {:error, "Invalid :ts_inspection option"}
+
+      _other ->
+        {:error, "Invalid :ts_inspection option"}
+    end
+  end
+
   @spec validate_password(String.t()) :: :ok | {:error, String.t()}
   defp validate_password(""), do: :ok
 
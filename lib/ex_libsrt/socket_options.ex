@@ -0,0 +1,91 @@
+defmodule ExLibSRT.SocketOptions do
+  @moduledoc """
+  Performance related SRT socket options, accepted by `ExLibSRT.Server` and `ExLibSRT.Client`
+  with the `:socket_options` option.
+
+  Options that are not given stay at libsrt's defaults, see
+  https://github.com/Haivision/srt/blob/master/docs/API/API-socket-options.md for their meaning.
+  High bitrate streams with large latencies usually need larger `:rcvbuf`, `:sndbuf` and `:fc`
+  than the defaults, as the buffers have to hold all the data sent within the latency window.
+
+  The server applies its options to every accepted connection, `ExLibSRT.Server.accept_awaiting_connect_request/3`
+  can override them for a single connection. `:mss`, `:rcvbuf` and `:sndbuf` have to be set before the socket
+  gets bound, so the server sets them on its listening socket and they can't be overridden per connection.
+  Value ranges get validated by the native layer.
+  """
+
+  @unset -1
+
+  @typedoc """
+  Socket options.
+
+  * `:rcvbuf`, `:sndbuf` - receive and send buffer sizes in bytes
+  * `:fc` - flow control window, the maximum number of packets in flight
+  * `:maxbw` - maximum sending bandwidth in bytes per second, `0` means no limit
+  * `:inputbw` - input rate of the sender in bytes per second, `0` makes it measured from the sent data
+  * `:oheadbw` - bandwidth allowed for retransmissions above the input rate, in percent
+  * `:tlpktdrop` - whether packets that are too late to be delivered get dropped
+  * `:nakreport` - whether the receiver periodically repeats its loss reports
+  * `:peerlatency` - minimum latency the peer is asked to use as a sender, in milliseconds
+  * `:congestion` - congestion controller, either `:live` or `:file`
+  * `:mss` - maximum segment size in bytes, including the IP and UDP headers
+  """
+  @type option ::
+          {:rcvbuf, pos_integer()}
+          | {:sndbuf, pos_integer()}
+          | {:fc, pos_integer()}
+          | {:maxbw, non_neg_integer()}
+          | {:inputbw, non_neg_integer()}
+          | {:oheadbw, pos_integer()}
+          | {:tlpktdrop, boolean()}
+          | {:nakreport, boolean()}
+          | {:peerlatency, non_neg_integer()}
+          | {:congestion, :live | :file}
+          | {:mss, pos_integer()}
+
+  @typedoc """
+  Options encoded for the native layer, `-1` or an empty string stand for the options that are not set.
+  """
+  @type t :: %__MODULE__{
+          rcvbuf: integer(),
+          sndbuf: integer(),
+          fc: integer(),
+          maxbw: integer(),
+          inputbw: integer(),
+          oheadbw: integer(),
+          tlpktdrop: integer(),
+          nakreport: integer(),
+          peerlatency: integer(),
+          congestion: String.t(),
+          mss: integer()
+        }
+
+  @integer_options [:rcvbuf, :sndbuf, :fc, :maxbw, :inputbw, :oheadbw, :peerlatency, :mss]
+  @boolean_options [:tlpktdrop, :nakreport]
+
+  defstruct Enum.map(@integer_options ++ @boolean_options, &{&1, @unset}) ++ [congestion: ""]
+
+  @doc false
+  @spec encode([option()]) :: {:ok, t()} | {:error, reason :: String.t()}
+  def encode(options) when is_list(options) do
+    Enum.reduce_while(options, {:ok, %__MODULE__{}}, fn option, {:ok, acc} ->
+      case encode_option(option) do
+        {:ok, key, value} -> {:cont, {:ok, Map.put(acc, key, value)}}
+        :error -> {:halt, {:error, "Invalid socket option: #{inspect(option)}"}}
+      end
+    end)
+  end
+
+  def encode(options), do: {:error, "Invalid socket options: #{inspect(options)}"}
+
+  defp encode_option({key, value}) when key in @integer_options and is_integer(value),
+    do: {:ok, key, value}
+
+  defp encode_option({key, value}) when key in @boolean_options and is_boolean(value),
+    do: {:ok, key, if(value, do: 1, else: 0)}
+
+  defp encode_option({:congestion, value}) when value in [:live, :file],
+    do: {:ok, :congestion, Atom.to_string(value)}
+
+  defp encode_option(_option), do: :error
+end
@@ -0,0 +1,78 @@
+defmodule ExLibSRT.TransferOptions do
+  @moduledoc """
+  Transmission settings shared by `ExLibSRT.Server` and `ExLibSRT.Client`.
+
+  SRT transfers data in one of two modes:
+  * live (default) - meant for real-time streams, each message is sent as a single packet
+    which gets delivered on time or dropped, so a message can't exceed the payload size
+    (`1316` bytes by default, fitting 7 MPEG-TS packets)
+  * file - meant for bulk transfers, messages get split into as many packets as needed
+    and are retransmitted until delivered, trading latency for throughput
+
+  Both sides of a connection have to use the same mode. The server applies its settings
+  to all the accepted connections.
+  """
+
+  @default_live_payload_size 1316
+  @max_payload_size 1456
+  @default_file_message_size 65_536
+  @max_file_message_size 16_777_216
+
+  @typedoc """
+  Transmission options.
+
+  * `:transtype` - either `:live` (default) or `:file`
+  * `:payload_size` - maximum payload of a single packet, at most `#{@max_payload_size}`,
+    defaults to `#{@default_live_payload_size}` in the live mode and to the largest possible one in the file mode
+  * `:message_api` - whether data is transferred as separate messages (default) or as a byte stream,
+    only the file mode can transfer a byte stream
+  * `:max_message_size` - largest message sent or received in one piece in the file mode,
+    at most `#{@max_file_message_size}`, defaults to `#{@default_file_message_size}`
+
+  Sending a message larger than the limit of the mode results in `{:error, :payload_too_large}`.
+  """
+  @type option ::
+          {:transtype, :live | :file}
+          | {:payload_size, pos_integer()}
+          | {:message_api, boolean()}
+          | {:max_message_size, pos_integer()}
+
+  @doc false
+  @spec native_params(keyword()) ::
+          {:ok,
+           {file_mode :: boolean(), payload_size :: non_neg_integer(), message_api :: boolean(),
+            max_message_size :: non_neg_integer()}}
+          | {:error, reason :: String.t()}
+  def native_params(opts) do
+    with {:ok, file_mode} <- transtype_param(opts),
+         {:ok, payload_size} <- size_param(opts, :payload_size, @max_payload_size),
+         {:ok, message_api} <- message_api_param(opts, file_mode),
+         {:ok, max_message_size} <- size_param(opts, :max_message_size, @max_file_message_size) do
+      {:ok, {file_mode, payload_size, message_api, max_message_size}}
+    end
+  end
+
+  defp transtype_param(opts) do
+    case Keyword.get(opts, :transtype, :live) do
+      :live -> {:ok, false}
+      :file -> {:ok, true}
+      _other -> {:error, "Invalid :transtype option"}
+    end
+  end
+
+  # 0 makes the native side use the default of the mode
+  defp size_param(opts, key, max) do
+    case Keyword.get(opts, key, 0) do
+      value when is_integer(value) and value >= 0 and value <= max -> {:ok, value}
+      _other -> {:error, "Invalid #{inspect(key)} option"}
+    end
+  end
+
+  defp message_api_param(opts, file_mode) do
+    case Keyword.get(opts, :message_api, true) do
+      true -> {:ok, true}
+      false when file_mode -> {:ok, false}
+      _other -> {:error, "Invalid :message_api option"}
+    end
+  end
+end
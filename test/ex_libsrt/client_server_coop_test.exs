@@ -13,7 +13,7 @@ defmodule ExLibSRT.ClientServerCoopTest do
 
       send(parent, :running)
 
-      assert_receive {:srt_server_connect_request, _address, "some_stream_id"}
+      assert_receive {:srt_server_connect_request, _address, "some_stream_id", _request_id}
 
       Server.accept_awaiting_connect_request(server)
 
@@ -49,7 +49,7 @@ defmodule ExLibSRT.ClientServerCoopTest do
 
       send(parent, :running)
 
-      assert_receive {:srt_server_connect_request, _address, "some_stream_id"}
+      assert_receive {:srt_server_connect_request, _address, "some_stream_id", _request_id}
 
       Server.reject_awaiting_connect_request(server)
 
@@ -93,7 +93,511 @@ defmodule ExLibSRT.ClientServerCoopTest do
     assert_receive :stopped, 2_000
   end
 
+  describe "admission rules" do
+    test "accept and reject connections natively", ctx do
+      assert {:ok, server} = Server.start("127.0.0.1", ctx.srt_port)
+
+      :ok =
+        Server.set_admission_rules(
+          [
+            stream_rules: [
+              {:reject, {:prefix, "forbidden/"}},
+              {:accept, {:exact, "allowed_stream"}},
+              {:accept, {:access_control, %{"m" => "publish"}}}
+            ]
+          ],
+          server
+        )
+
+      assert {:ok, client} = Client.start("127.0.0.1", ctx.srt_port, "allowed_stream")
+      assert_receive :srt_client_connected, 500
+      assert_receive {:srt_server_conn, _conn_id, "allowed_stream"}, 1_000
+
+      assert {:ok, publisher} = Client.start("127.0.0.1", ctx.srt_port, "#!::r=live/cam1,m=publish")
+      assert_receive :srt_client_connected, 500
+
+      assert {:error, "Stream rejected by server", 403} =
+               Client.start("127.0.0.1", ctx.srt_port, "forbidden/stream")
+
+      refute_received {:srt_server_connect_request, _address, _stream_id, _request_id}
+
+      :ok = Client.stop(client)
+      :ok = Client.stop(publisher)
+      Server.stop(server)
+    end
+
+    test "fall back to the owner for unmatched requests", ctx do
+      parent = self()
+
+      Task.start(fn ->
+        assert {:ok, server} = Server.start("127.0.0.1", ctx.srt_port)
+
+        :ok = Server.set_admission_rules([stream_rules: [{:accept, {:exact, "other"}}]], server)
+
+        send(parent, :running)
+
+        assert_receive {:srt_server_connect_request, _address, "unmatched", request_id}, 1_000
+        :ok = Server.reject_awaiting_connect_request(request_id, server)
+
+        Process.sleep(100)
+
+        Server.stop(server)
+
+        send(parent, :stopped)
+      end)
+
+      assert_receive :running, 500
+
+      assert {:error, "Stream rejected by server", 403} =
+               Client.start("127.0.0.1", ctx.srt_port, "unmatched")
+
+      assert_receive :stopped, 2_000
+    end
+
+    test "reject connections above the limit", ctx do
+      assert {:ok, server} = Server.start("127.0.0.1", ctx.srt_port)
+
+      :ok =
+        Server.set_admission_rules(
+          [max_connections: 1, stream_rules: [{:accept, {:prefix, ""}}]],
+          server
+        )
+
+      assert {:ok, client} = Client.start("127.0.0.1", ctx.srt_port, "first")
+      assert_receive {:srt_server_conn, _conn_id, "first"}, 1_000
+
+      assert {:error, "Stream rejected by server", 402} =
+               Client.start("127.0.0.1", ctx.srt_port, "second")
+
+      :ok = Client.stop(client)
+      Server.stop(server)
+    end
+
+    test "reject peers outside of the allowed networks", ctx do
+      assert {:ok, server} = Server.start("127.0.0.1", ctx.srt_port)
+
+      :ok = Server.set_admission_rules([allow_peers: ["10.0.0.0/8"]], server)
+
+      assert {:error, "Stream rejected by server", 403} =
+               Client.start("127.0.0.1", ctx.srt_port, "some_stream_id")
+
+      Server.stop(server)
+    end
+
+    test "validate rules", ctx do
+      assert {:ok, server} = Server.start("127.0.0.1", ctx.srt_port)
+
+      assert {:error, "Invalid network address: not_a_network"} =
+               Server.set_admission_rules([deny_peers: ["not_a_network"]], server)
+
+      assert {:error, "Invalid stream rule: " <> _rule} =
+               Server.set_admission_rules([stream_rules: [{:maybe, {:exact, "x"}}]], server)
+
+      Server.stop(server)
+    end
+  end
+
   # Password authentication tests
+  describe "native relay" do
+    test "forward data from an ingest connection to an outbound client", ctx do
+      ingest_port = ctx.srt_port
+      sink_port = ctx.srt_port + 1
+
+      accept_all = [stream_rules: [{:accept, {:prefix, ""}}]]
+
+      assert {:ok, ingest_server} = Server.start("127.0.0.1", ingest_port)
+      :ok = Server.set_admission_rules(accept_all, ingest_server)
+
+      assert {:ok, sink_server} = Server.start("127.0.0.1", sink_port)
+      :ok = Server.set_admission_rules(accept_all, sink_server)
+
+      assert {:ok, outbound} = Client.start("127.0.0.1", sink_port, "relayed")
+      assert_receive :srt_client_connected, 500
+      assert_receive {:srt_server_conn, sink_conn_id, "relayed"}, 1_000
+
+      :ok = Server.add_relay_route("ingest", outbound, ingest_server)
+
+      assert {:ok, ingest} = Client.start("127.0.0.1", ingest_port, "ingest")
+      assert_receive :srt_client_connected, 500
+      assert_receive {:srt_server_conn, ingest_conn_id, "ingest"}, 1_000
+
+      for i <- 1..5 do
+        :ok = Client.send_data("relayed payload #{i}", ingest)
+      end
+
+      for i <- 1..5 do
+        assert_receive {:srt_data, ^sink_conn_id, payload}, 1_000
+        assert payload == "relayed payload #{i}"
+      end
+
+      refute_received {:srt_data, ^ingest_conn_id, _payload}
+
+      :ok = Server.remove_relay_route("ingest", outbound, ingest_server)
+      :ok = Client.send_data("not relayed", ingest)
+
+      assert_receive {:srt_data, ^ingest_conn_id, "not relayed"}, 1_000
+
+      :ok = Client.stop(ingest)
+      :ok = Client.stop(outbound)
+      Server.stop(ingest_server)
+      Server.stop(sink_server)
+    end
+
+    test "refuse a receiver client as a relay target", ctx do
+      ingest_port = ctx.srt_port
+      source_port = ctx.srt_port + 1
+
+      assert {:ok, ingest_server} = Server.start("127.0.0.1", ingest_port)
+
+      assert {:ok, source_server} = Server.start("127.0.0.1", source_port)
+      accept_pulled = [stream_rules: [{:accept, {:exact, "pulled"}}]]
+      :ok = Server.set_admission_rules(accept_pulled, source_server)
+
+      assert {:ok, receiver} =
+               Client.start("127.0.0.1", source_port, "pulled", "", -1, mode: :receiver)
+
+      assert_receive :srt_client_connected, 500
+
+      assert {:error, "Client is in receiver mode"} =
+               Server.add_relay_route("ingest", receiver, ingest_server)
+
+      :ok = Client.stop(receiver)
+      Server.stop(ingest_server)
+      Server.stop(source_server)
+    end
+  end
+
+  describe "receiver mode" do
+    test "pull data from the server", ctx do
+      assert {:ok, server} = Server.start("127.0.0.1", ctx.srt_port)
+      :ok = Server.set_admission_rules([stream_rules: [{:accept, {:exact, "pulled"}}]], server)
+
+      assert {:ok, client} =
+               Client.start("127.0.0.1", ctx.srt_port, "pulled", "", -1, mode: :receiver)
+
+      assert_receive :srt_client_connected, 500
+      assert_receive {:srt_server_conn, conn_id, "pulled"}, 1_000
+
+      expected = for i <- 1..10, do: "pulled payload #{i}"
+
+      for payload <- expected do
+        assert {:ok, []} = Server.send_data(payload, conn_id, server)
+      end
+
+      assert receive_client_batches(length(expected)) == expected
+
+      assert {:error, "Client is in receiver mode"} = Client.send_data("payload", client)
+
+      :ok = Client.stop(client)
+      Server.stop(server)
+    end
+
+    test "validate receiver options", ctx do
+      assert {:error, "Invalid :mode option", 0} =
+               Client.start("127.0.0.1", ctx.srt_port, "pulled", "", -1, mode: :both)
+
+      assert {:error, "Invalid receive batch options", 0} =
+               Client.start("127.0.0.1", ctx.srt_port, "pulled", "", -1,
+                 receive_batch: [max_packets: 0]
+               )
+    end
+  end
+
+  describe "connection closing" do
+    test "close a connection within the workers' mailbox check interval", ctx do
+      assert {:ok, server} = Server.start("127.0.0.1", ctx.srt_port, "", -1, workers: 2)
+      :ok = Server.set_admission_rules([stream_rules: [{:accept, {:exact, "closed"}}]], server)
+
+      assert {:ok, client} = Client.start("127.0.0.1", ctx.srt_port, "closed")
+
+      assert_receive :srt_client_connected, 500
+      assert_receive {:srt_server_conn, conn_id, "closed"}, 1_000
+
+      start = System.monotonic_time(:millisecond)
+      :ok = Server.close_server_connection(conn_id, server)
+
+      assert_receive {:srt_server_conn_closed, ^conn_id}, 500
+
+      # the workers check their mailboxes every 10 ms, the rest is a margin for the notification
+      assert System.monotonic_time(:millisecond) - start < 50
+
+      Client.stop(client)
+      Server.stop(server)
+    end
+  end
+
+  describe "client send queue" do
+    test "survive a burst overflowing the sender buffer", ctx do
+      # the file mode never drops messages, so each of them has to arrive despite the full buffer
+      opts = [transtype: :file, max_message_size: 10_000]
+
+      assert {:ok, server} = Server.start("127.0.0.1", ctx.srt_port, "", -1, opts)
+      :ok = Server.set_admission_rules([stream_rules: [{:accept, {:exact, "burst"}}]], server)
+
+      assert {:ok, client} =
+               Client.start(
+                 "127.0.0.1",
+                 ctx.srt_port,
+                 "burst",
+                 "",
+                 -1,
+                 [send_queue_capacity: 64, send_ttl_ms: 5_000, socket_options: [sndbuf: 48_000]] ++
+                   opts
+               )
+
+      assert_receive :srt_client_connected, 500
+      assert_receive {:srt_server_conn, conn_id, "burst"}, 1_000
+
+      # 2 MB sent at once, way more than the smallest sender buffer holds
+      expected = for i <- 1..200, do: <<i::32>> <> :binary.copy(<<i::8>>, 9_996)
+
+      for payload <- expected do
+        assert :ok = Client.send_data(payload, client)
+      end
+
+      received =
+        for _payload <- expected do
+          assert_receive {:srt_data, ^conn_id, payload}, 5_000
+          payload
+        end
+
+      assert received == expected
+
+      refute_received :srt_client_disconnected
+      refute_received {:srt_client_error, _reason}
+
+      :ok = Client.stop(client)
+      Server.stop(server)
+    end
+  end
+
+  describe "file mode" do
+    test "transfer messages larger than a live packet", ctx do
+      opts = [transtype: :file, max_message_size: 100_000]
+
+      assert {:ok, server} = Server.start("127.0.0.1", ctx.srt_port, "", -1, opts)
+      :ok = Server.set_admission_rules([stream_rules: [{:accept, {:exact, "file"}}]], server)
+
+      assert {:ok, client} = Client.start("127.0.0.1", ctx.srt_port, "file", "", -1, opts)
+
+      assert_receive :srt_client_connected, 500
+      assert_receive {:srt_server_conn, conn_id, "file"}, 1_000
+
+      payload = :crypto.strong_rand_bytes(50_000)
+      :ok = Client.send_data(payload, client)
+
+      assert_receive {:srt_data, ^conn_id, ^payload}, 2_000
+
+      assert {:error, :payload_too_large} =
+               Client.send_data(:binary.copy(<<0>>, 100_001), client)
+
+      :ok = Client.stop(client)
+      Server.stop(server)
+    end
+
+    test "batch small messages together with ones larger than the receive region", ctx do
+      opts = [transtype: :file, max_message_size: 1_000_000]
+
+      assert {:ok, server} =
+               Server.start("127.0.0.1", ctx.srt_port, "", -1, [receive_batch: true] ++ opts)
+
+      :ok = Server.set_admission_rules([stream_rules: [{:accept, {:exact, "file"}}]], server)
+
+      assert {:ok, client} = Client.start("127.0.0.1", ctx.srt_port, "file", "", -1, opts)
+
+      assert_receive :srt_client_connected, 500
+      assert_receive {:srt_server_conn, conn_id, "file"}, 1_000
+
+      expected = [
+        "small payload",
+        :crypto.strong_rand_bytes(500_000),
+        "another small payload",
+        :crypto.strong_rand_bytes(200_000)
+      ]
+
+      for payload <- expected do
+        :ok = Client.send_data(payload, client)
+      end
+
+      assert receive_batches(conn_id, length(expected)) == expected
+
+      :ok = Client.stop(client)
+      Server.stop(server)
+    end
+
+    test "validate transfer options", ctx do
+      assert {:error, "Invalid :transtype option", 0} =
+               Client.start("127.0.0.1", ctx.srt_port, "file", "", -1, transtype: :stream)
+
+      assert {:error, "Invalid :message_api option", 0} =
+               Server.start("127.0.0.1", ctx.srt_port, "", -1, message_api: false)
+    end
+  end
+
+  describe "socket options" do
+    test "connect with tuned socket options", ctx do
+      parent = self()
+
+      Task.start(fn ->
+        assert {:ok, server} =
+                 Server.start("127.0.0.1", ctx.srt_port, "", -1,
+                   socket_options: [
+                     rcvbuf: 16_000_000,
+                     sndbuf: 16_000_000,
+                     mss: 1400,
+                     fc: 32_000,
+                     tlpktdrop: true
+                   ]
+                 )
+
+        send(parent, :server_running)
+
+        assert_receive {:srt_server_connect_request, _address, "tuned", request_id}
+
+        :ok =
+          Server.accept_awaiting_connect_request(
+            request_id,
+            [maxbw: 0, oheadbw: 50, congestion: :live],
+            server
+          )
+
+        assert_receive {:srt_server_conn, _conn_id, "tuned"}, 1_000
+
+        send(parent, :connection_accepted)
+
+        Server.stop(server)
+      end)
+
+      assert_receive :server_running, 1_000
+
+      assert {:ok, client} =
+               Client.start("127.0.0.1", ctx.srt_port, "tuned", "", -1,
+                 socket_options: [sndbuf: 16_000_000, fc: 32_000, nakreport: true]
+               )
+
+      assert_receive :srt_client_connected, 2_000
+      assert_receive :connection_accepted, 1_000
+
+      Client.stop(client)
+    end
+
+    test "keep the peer latency set apart from the latency", ctx do
+      assert {:ok, server} = Server.start("127.0.0.1", ctx.srt_port, "", 50)
+      :ok = Server.set_admission_rules([stream_rules: [{:accept, {:exact, "delayed"}}]], server)
+
+      assert {:ok, client} =
+               Client.start("127.0.0.1", ctx.srt_port, "delayed", "", 50,
+                 socket_options: [peerlatency: 300]
+               )
+
+      assert_receive :srt_client_connected, 500
+      assert_receive {:srt_server_conn, conn_id, "delayed"}, 1_000
+
+      # the receiving server is asked for the larger latency of the two
+      assert {:ok, %ExLibSRT.SocketStats{msSndTsbPdDelay: 300}} = Client.read_socket_stats(client)
+
+      assert {:ok, %ExLibSRT.SocketStats{msRcvTsbPdDelay: 300}} =
+               Server.read_socket_stats(conn_id, server)
+
+      :ok = Client.stop(client)
+      Server.stop(server)
+    end
+
+    test "validate socket options", ctx do
+      assert {:error, "Invalid socket option: {:rcvbuf, :large}", 0} =
+               Client.start("127.0.0.1", ctx.srt_port, "tuned", "", -1,
+                 socket_options: [rcvbuf: :large]
+               )
+
+      assert {:error, "Invalid mss socket option", 0} =
+               Server.start("127.0.0.1", ctx.srt_port, "", -1, socket_options: [mss: 10])
+
+      assert {:ok, server} = Server.start("127.0.0.1", ctx.srt_port)
+
+      assert {:error, "Invalid fc socket option"} =
+               Server.accept_awaiting_connect_request(1, [fc: 1], server)
+
+      assert {:error, "mss, rcvbuf and sndbuf socket options can't be set per connection"} =
+               Server.accept_awaiting_connect_request(1, [rcvbuf: 16_000_000], server)
+
+      Server.stop(server)
+    end
+  end
+
+  describe "MPEG-TS inspection" do
+    test "deliver only the allowed PIDs and count stream errors", ctx do
+      assert {:ok, server} =
+               Server.start("127.0.0.1", ctx.srt_port, "", -1, ts_inspection: [pids: [256]])
+
+      :ok = Server.set_admission_rules([stream_rules: [{:accept, {:exact, "ts"}}]], server)
+
+      assert {:ok, client} = Client.start("127.0.0.1", ctx.srt_port, "ts")
+      assert_receive :srt_client_connected, 500
+      assert_receive {:srt_server_conn, conn_id, "ts"}, 1_000
+
+      # the continuity counter of PID 256 skips from 1 to 3
+      payload =
+        ts_packet(256, 0, <<0xAA>>) <>
+          ts_packet(257, 0, <<0xBB>>) <> ts_packet(256, 1, <<0xCC>>) <> ts_packet(256, 3, <<0xDD>>)
+
+      :ok = Client.send_data(payload, client)
+
+      assert_receive {:srt_data, ^conn_id, data}, 1_000
+
+      assert data ==
+               ts_packet(256, 0, <<0xAA>>) <> ts_packet(256, 1, <<0xCC>>) <> ts_packet(256, 3, <<0xDD>>)
+
+      assert {:ok, stats} = Server.read_ts_stats(conn_id, server)
+      assert %ExLibSRT.TsStats{packets: 4, forwarded_packets: 3, cc_errors: 1, last_pcr: nil} = stats
+
+      :ok = Client.stop(client)
+      Server.stop(server)
+    end
+
+    test "deliver payloads intact and extract PCRs without PID filtering", ctx do
+      assert {:ok, server} = Server.start("127.0.0.1", ctx.srt_port, "", -1, ts_inspection: true)
+
+      :ok = Server.set_admission_rules([stream_rules: [{:accept, {:exact, "ts"}}]], server)
+
+      assert {:ok, client} = Client.start("127.0.0.1", ctx.srt_port, "ts")
+      assert_receive :srt_client_connected, 500
+      assert_receive {:srt_server_conn, conn_id, "ts"}, 1_000
+
+      # the middle packet lacks the sync byte
+      broken_packet = <<0x00>> <> binary_part(ts_packet(257, 0, <<0xBB>>), 1, 187)
+
+      payload =
+        ts_pcr_packet(256, 0, 1_234_567, 89) <> broken_packet <> ts_packet(256, 1, <<0xCC>>)
+
+      :ok = Client.send_data(payload, client)
+
+      assert_receive {:srt_data, ^conn_id, ^payload}, 1_000
+
+      assert {:ok, stats} = Server.read_ts_stats(conn_id, server)
+
+      assert %ExLibSRT.TsStats{
+               packets: 3,
+               forwarded_packets: 3,
+               sync_errors: 1,
+               cc_errors: 0,
+               pcr_count: 1,
+               last_pcr: 370_370_189,
+               last_pcr_pid: 256
+             } = stats
+
+      :ok = Client.stop(client)
+      Server.stop(server)
+    end
+
+    test "validate inspection options", ctx do
+      assert {:error, "Invalid TS PID: 8192", 0} =
+               Server.start("127.0.0.1", ctx.srt_port, "", -1, ts_inspection: [pids: [8192]])
+
+      assert {:error, "Invalid :ts_inspection option", 0} =
+               Server.start("127.0.0.1", ctx.srt_port, "", -1, ts_inspection: [pids: :all])
+    end
+  end
+
   describe "client-server password authentication" do
     test "successful connection with matching passwords", ctx do
       password = "validpassword123"
@@ -103,7 +607,7 @@ defmodule ExLibSRT.ClientServerCoopTest do
         assert {:ok, server} = Server.start("127.0.0.1", ctx.srt_port, password)
         send(parent, :server_running)
 
-        assert_receive {:srt_server_connect_request, _address, "auth_stream"}
+        assert_receive {:srt_server_connect_request, _address, "auth_stream", _request_id}
         Server.accept_awaiting_connect_request(server)
 
         assert_receive {:srt_server_conn, _conn_id, _stream_id}, 1_000
@@ -133,7 +637,7 @@ defmodule ExLibSRT.ClientServerCoopTest do
 
         # Server may receive connect request but should reject due to password mismatch
         receive do
-          {:srt_server_connect_request, _address, "auth_stream"} ->
+          {:srt_server_connect_request, _address, "auth_stream", _request_id} ->
             Server.accept_awaiting_connect_request(server)
         after
           2_000 -> :timeout
@@ -162,7 +666,7 @@ defmodule ExLibSRT.ClientServerCoopTest do
         send(parent, :server_running)
 
         receive do
-          {:srt_server_connect_request, _address, "auth_stream"} ->
+          {:srt_server_connect_request, _address, "auth_stream", _request_id} ->
             Server.accept_awaiting_connect_request(server)
         after
           2_000 -> :timeout
@@ -192,7 +696,7 @@ defmodule ExLibSRT.ClientServerCoopTest do
         send(parent, :server_running)
 
         receive do
-          {:srt_server_connect_request, _address, "auth_stream"} ->
+          {:srt_server_connect_request, _address, "auth_stream", _request_id} ->
             Server.accept_awaiting_connect_request(server)
         after
           2_000 -> :timeout
@@ -220,7 +724,7 @@ defmodule ExLibSRT.ClientServerCoopTest do
         assert {:ok, server} = Server.start("127.0.0.1", ctx.srt_port)
         send(parent, :server_running)
 
-        assert_receive {:srt_server_connect_request, _address, "no_auth_stream"}
+        assert_receive {:srt_server_connect_request, _address, "no_auth_stream", _request_id}
         Server.accept_awaiting_connect_request(server)
 
         assert_receive {:srt_server_conn, _conn_id, _stream_id}, 1_000
@@ -241,6 +745,41 @@ defmodule ExLibSRT.ClientServerCoopTest do
     end
   end
 
+  defp receive_client_batches(count, acc \\ [])
+
+  defp receive_client_batches(count, acc) when count <= 0, do: acc
+
+  defp receive_client_batches(count, acc) do
+    assert_receive {:srt_client_data_batch, packets}, 1_000
+
+    receive_client_batches(count - length(packets), acc ++ packets)
+  end
+
+  defp receive_batches(conn_id, count, acc \\ [])
+
+  defp receive_batches(_conn_id, count, acc) when count <= 0, do: acc
+
+  defp receive_batches(conn_id, count, acc) do
+    assert_receive {:srt_data_batch, ^conn_id, packets}, 2_000
+
+    receive_batches(conn_id, count - length(packets), acc ++ packets)
+  end
+
+  defp ts_packet(pid, continuity_counter, payload) do
+    header = <<0x47, 0::3, pid::13, 0::2, 1::2, continuity_counter::4>>
+
+    header <> payload <> :binary.copy(<<0xFF>>, 188 - byte_size(header) - byte_size(payload))
+  end
+
+  defp ts_pcr_packet(pid, continuity_counter, pcr_base, pcr_extension) do
+    header = <<0x47, 0::3, pid::13, 0::2, 3::2, continuity_counter::4>>
+    adaptation_field = <<7, 0x10, pcr_base::33, 0x3F::6, pcr_extension::9>>
+
+    header <>
+      adaptation_field <>
+      :binary.copy(<<0xFF>>, 188 - byte_size(header) - byte_size(adaptation_field))
+  end
+
   defp prepare_streaming(_ctx) do
     udp_port = Enum.random(10_000..20_000)
     srt_port = Enum.random(10_000..20_000)
@@ -52,6 +52,27 @@ defmodule ExLibSRT.ClientTest do
     assert {:error, "Client is not active"} = Client.send_data("test payload", client)
   end
 
+  @tag :srt_tools_required
+  test "stop once the enqueued data is sent", ctx do
+    proxy = Transmit.start_receiving_proxy(ctx.srt_port, ctx.udp_port)
+    on_exit(fn -> stop_proxy_safe(proxy) end)
+
+    receiver = Transmit.start_stream_receiver(ctx.udp_port)
+    on_exit(fn -> close_stream_safe(receiver) end)
+
+    assert {:ok, client} =
+             Client.start("127.0.0.1", ctx.srt_port, "some_stream_id", "", -1, linger_ms: 2_000)
+
+    assert_receive :srt_client_connected
+
+    :ok = Client.send_data("last payload", client)
+
+    {time_us, :ok} = :timer.tc(fn -> Client.stop(client) end)
+
+    assert time_us < 1_000_000
+    assert {:ok, "last payload"} = Transmit.receive_payload(receiver)
+  end
+
   @tag :srt_tools_required
   test "get disconnected notification when servers closes", ctx do
     proxy = Transmit.start_receiving_proxy(ctx.srt_port, ctx.udp_port)
@@ -95,6 +116,107 @@ defmodule ExLibSRT.ClientTest do
     assert stats.byteSentTotal > 1_000
   end
 
+  @tag :srt_tools_required
+  test "send data through a custom sized send queue", ctx do
+    proxy = Transmit.start_receiving_proxy(ctx.srt_port, ctx.udp_port)
+    on_exit(fn -> stop_proxy_safe(proxy) end)
+
+    receiver = Transmit.start_stream_receiver(ctx.udp_port)
+    on_exit(fn -> close_stream_safe(receiver) end)
+
+    assert {:ok, client} =
+             Client.start("127.0.0.1", ctx.srt_port, "some_stream_id", "", -1,
+               send_queue_capacity: 2,
+               send_ttl_ms: 500
+             )
+
+    on_exit(fn -> stop_client_safe(client) end)
+
+    assert_receive :srt_client_connected
+
+    for i <- 0..10 do
+      :ok = Client.send_data("test payload #{i}", client)
+
+      assert {:ok, payload} = Transmit.receive_payload(receiver)
+      assert payload == "test payload #{i}"
+    end
+  end
+
+  @tag :srt_tools_required
+  test "send a batch of data to a server", ctx do
+    proxy = Transmit.start_receiving_proxy(ctx.srt_port, ctx.udp_port)
+    on_exit(fn -> stop_proxy_safe(proxy) end)
+
+    receiver = Transmit.start_stream_receiver(ctx.udp_port)
+    on_exit(fn -> close_stream_safe(receiver) end)
+
+    assert {:ok, client} =
+             Client.start("127.0.0.1", ctx.srt_port, "some_stream_id", "", -1,
+               send_queue_capacity: 4
+             )
+
+    on_exit(fn -> stop_client_safe(client) end)
+
+    assert_receive :srt_client_connected
+
+    payloads = for i <- 0..5, do: "test payload #{i}"
+
+    assert {:ok, accepted} = Client.send_data_batch(payloads, client)
+    assert accepted in 4..6
+
+    for i <- 0..(accepted - 1) do
+      assert {:ok, payload} = Transmit.receive_payload(receiver)
+      assert payload == "test payload #{i}"
+    end
+
+    assert {:error, :payload_too_large} =
+             Client.send_data_batch([:binary.copy(<<0>>, 1317)], client)
+  end
+
+  @tag :srt_tools_required
+  test "get notified about a ready send queue in the non-blocking mode", ctx do
+    proxy = Transmit.start_receiving_proxy(ctx.srt_port, ctx.udp_port)
+    on_exit(fn -> stop_proxy_safe(proxy) end)
+
+    receiver = Transmit.start_stream_receiver(ctx.udp_port)
+    on_exit(fn -> close_stream_safe(receiver) end)
+
+    # the smallest sender buffer drained at a low rate can't keep up with the burst below,
+    # so the send queue is bound to fill up
+    assert {:ok, client} =
+             Client.start("127.0.0.1", ctx.srt_port, "some_stream_id", "", -1,
+               send_queue_capacity: 2,
+               non_blocking: true,
+               socket_options: [sndbuf: 48_000, maxbw: 100_000]
+             )
+
+    on_exit(fn -> stop_client_safe(client) end)
+
+    assert_receive :srt_client_connected
+
+    payload = :binary.copy(<<0>>, 1316)
+    results = for _i <- 0..1_000, do: Client.send_data(payload, client)
+
+    assert :ok in results
+    assert {:error, :would_block} in results
+
+    assert_receive :srt_client_ready, 2_000
+  end
+
+  test "rejects invalid send queue options" do
+    assert {:error, "Invalid :send_queue_capacity option", 0} =
+             Client.start("127.0.0.1", 9999, "stream1", "", -1, send_queue_capacity: 0)
+
+    assert {:error, "Invalid :send_ttl_ms option", 0} =
+             Client.start("127.0.0.1", 9999, "stream1", "", -1, send_ttl_ms: :infinity)
+
+    assert {:error, "Invalid :send_queue_low_watermark option", 0} =
+             Client.start("127.0.0.1", 9999, "stream1", "", -1,
+               send_queue_capacity: 4,
+               send_queue_low_watermark: 4
+             )
+  end
+
   # Password validation tests
   describe "client password validation" do
     test "rejects too short password" do
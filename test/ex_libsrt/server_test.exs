@@ -20,7 +20,7 @@ defmodule ExLibSRT.ServerTest do
 
       on_exit(fn -> stop_proxy_safe(proxy) end)
 
-      assert_receive {:srt_server_connect_request, address, ^stream_id}, 2_000
+      assert_receive {:srt_server_connect_request, address, ^stream_id, _request_id}, 2_000
       assert address == "127.0.0.1"
 
       :ok = Server.accept_awaiting_connect_request(ctx.server)
@@ -30,13 +30,33 @@ defmodule ExLibSRT.ServerTest do
       Transmit.stop_proxy(proxy)
     end
 
+    @tag :srt_tools_required
+    test "accept a connection by its request id", ctx do
+      proxy = Transmit.start_streaming_proxy(ctx.udp_port, ctx.srt_port, "keyed_stream_id")
+      on_exit(fn -> stop_proxy_safe(proxy) end)
+
+      assert_receive {:srt_server_connect_request, _address, "keyed_stream_id", request_id}, 2_000
+
+      assert {:error, "Connect request not found"} =
+               Server.accept_awaiting_connect_request(request_id + 1, ctx.server)
+
+      :ok = Server.accept_awaiting_connect_request(request_id, ctx.server)
+
+      assert_receive {:srt_server_conn, ^request_id, "keyed_stream_id"}, 1_000
+
+      assert {:error, "Connect request not found"} =
+               Server.reject_awaiting_connect_request(request_id, ctx.server)
+
+      Transmit.stop_proxy(proxy)
+    end
+
     @tag :srt_tools_required
     test "decline the connection", ctx do
       stream_id = "forbidden_stream_id"
       proxy = Transmit.start_streaming_proxy(ctx.udp_port, ctx.srt_port, stream_id)
       on_exit(fn -> stop_proxy_safe(proxy) end)
 
-      assert_receive {:srt_server_connect_request, address, ^stream_id}, 2_000
+      assert_receive {:srt_server_connect_request, address, ^stream_id, _request_id}, 2_000
       assert address == "127.0.0.1"
 
       Server.reject_awaiting_connect_request(ctx.server)
@@ -54,7 +74,7 @@ defmodule ExLibSRT.ServerTest do
       stream = Transmit.start_stream(ctx.udp_port)
       on_exit(fn -> close_stream_safe(stream) end)
 
-      assert_receive {:srt_server_connect_request, address, _stream_id}, 2_000
+      assert_receive {:srt_server_connect_request, address, _stream_id, _request_id}, 2_000
       assert address == "127.0.0.1"
 
       :ok = Server.accept_awaiting_connect_request(ctx.server)
@@ -75,6 +95,35 @@ defmodule ExLibSRT.ServerTest do
       Transmit.stop_proxy(proxy)
     end
 
+    @tag :srt_tools_required
+    test "record native metrics", ctx do
+      metrics_before = ExLibSRT.NativeMetrics.read()
+
+      proxy = Transmit.start_streaming_proxy(ctx.udp_port, ctx.srt_port)
+      on_exit(fn -> stop_proxy_safe(proxy) end)
+
+      stream = Transmit.start_stream(ctx.udp_port)
+      on_exit(fn -> close_stream_safe(stream) end)
+
+      assert_receive {:srt_server_connect_request, _address, _stream_id, _request_id}, 2_000
+      :ok = Server.accept_awaiting_connect_request(ctx.server)
+
+      assert_receive {:srt_server_conn, conn_id, _stream_id}, 1_000
+
+      for i <- 1..10 do
+        :ok = Transmit.send_payload(stream, "Hello world! (#{i})")
+
+        assert_receive {:srt_data, ^conn_id, _payload}, 500
+      end
+
+      metrics = ExLibSRT.NativeMetrics.read()
+
+      assert metrics.epoll_wakeups > metrics_before.epoll_wakeups
+      assert metrics.data_callback_us.count >= metrics_before.data_callback_us.count + 10
+      assert metrics.packets_per_wakeup.sum >= metrics_before.packets_per_wakeup.sum + 10
+      assert metrics.connection_lookup_us.count > metrics_before.connection_lookup_us.count
+    end
+
     @tag :srt_tools_required
     test "can handle multiple connections", ctx do
       streams =
@@ -82,7 +131,7 @@ defmodule ExLibSRT.ServerTest do
           proxy = Transmit.start_streaming_proxy(udp_port, ctx.srt_port, "stream_#{udp_port}")
           on_exit(fn -> stop_proxy_safe(proxy) end)
 
-          assert_receive {:srt_server_connect_request, _address, _stream_id}, 2_000
+          assert_receive {:srt_server_connect_request, _address, _stream_id, _request_id}, 2_000
 
           :ok = Server.accept_awaiting_connect_request(ctx.server)
 
@@ -116,7 +165,7 @@ defmodule ExLibSRT.ServerTest do
 
       on_exit(fn -> stop_proxy_safe(proxy) end)
 
-      assert_receive {:srt_server_connect_request, _address, _stream_id}, 2_000
+      assert_receive {:srt_server_connect_request, _address, _stream_id, _request_id}, 2_000
       :ok = Server.accept_awaiting_connect_request(ctx.server)
 
       assert_receive {:srt_server_conn, conn_id, _stream_id}, 1_000
@@ -136,7 +185,7 @@ defmodule ExLibSRT.ServerTest do
 
       on_exit(fn -> stop_proxy_safe(proxy) end)
 
-      assert_receive {:srt_server_connect_request, _address, _stream_id}, 2_000
+      assert_receive {:srt_server_connect_request, _address, _stream_id, _request_id}, 2_000
       :ok = Server.accept_awaiting_connect_request(ctx.server)
 
       assert_receive {:srt_server_conn, conn_id, _stream_id}, 1_000
@@ -156,7 +205,7 @@ defmodule ExLibSRT.ServerTest do
 
       on_exit(fn -> stop_proxy_safe(proxy) end)
 
-      assert_receive {:srt_server_connect_request, _address, _stream_id}, 2_000
+      assert_receive {:srt_server_connect_request, _address, _stream_id, _request_id}, 2_000
       :ok = Server.accept_awaiting_connect_request(ctx.server)
 
       assert_receive {:srt_server_conn, conn_id, _stream_id}, 1_000
@@ -177,8 +226,95 @@ defmodule ExLibSRT.ServerTest do
       assert %ExLibSRT.SocketStats{} = stats
       assert stats.pktRecv == 10
       assert stats.byteRecvTotal > 1_000
+      assert stats.msRTT >= 0
+      assert stats.byteAvailRcvBuf > 0
 
       assert {:error, "Socket not found"} = Server.read_socket_stats(2137, ctx.server)
+
+      assert {:ok, histograms} = Server.read_latency_histograms(conn_id, ctx.server)
+      assert Enum.sum(Enum.map(histograms.rtt, &elem(&1, 1))) >= 1
+      assert {:infinity, _count} = List.last(histograms.rcv_buf_delay)
+
+      assert {:error, "Socket not found"} = Server.read_latency_histograms(2137, ctx.server)
+    end
+
+    @tag :srt_tools_required
+    test "read aggregate stats", ctx do
+      assert {:ok, %ExLibSRT.AggregateStats{connections: 0}} =
+               Server.read_aggregate_stats(ctx.server)
+
+      proxy =
+        Transmit.start_streaming_proxy(
+          ctx.udp_port,
+          ctx.srt_port
+        )
+
+      on_exit(fn -> stop_proxy_safe(proxy) end)
+
+      assert_receive {:srt_server_connect_request, _address, _stream_id, _request_id}, 2_000
+      :ok = Server.accept_awaiting_connect_request(ctx.server)
+
+      assert_receive {:srt_server_conn, conn_id, _stream_id}, 1_000
+
+      stream = Transmit.start_stream(ctx.udp_port)
+      on_exit(fn -> close_stream_safe(stream) end)
+
+      payload = :crypto.strong_rand_bytes(100)
+
+      for _i <- 1..10 do
+        :ok = Transmit.send_payload(stream, payload)
+
+        assert_receive {:srt_data, ^conn_id, ^payload}, 1_000
+      end
+
+      assert {:ok, stats} = Server.read_aggregate_stats(ctx.server)
+
+      assert stats.connections == 1
+      assert stats.pktRecvTotal == 10
+      assert stats.byteRecvTotal > 1_000
+      assert stats.msRTTMin == stats.msRTTMax
+      assert stats.msRTTP50 == stats.msRTTMin
+      assert stats.rcvBufFillMax <= 100.0
+    end
+
+    @tag :srt_tools_required
+    test "push sampled socket stats", ctx do
+      proxy =
+        Transmit.start_streaming_proxy(
+          ctx.udp_port,
+          ctx.srt_port
+        )
+
+      on_exit(fn -> stop_proxy_safe(proxy) end)
+
+      assert_receive {:srt_server_connect_request, _address, _stream_id, _request_id}, 2_000
+      :ok = Server.accept_awaiting_connect_request(ctx.server)
+
+      assert_receive {:srt_server_conn, conn_id, _stream_id}, 1_000
+
+      :ok = Server.start_stats_sampler(100, self(), ctx.server)
+
+      stream = Transmit.start_stream(ctx.udp_port)
+      on_exit(fn -> close_stream_safe(stream) end)
+
+      payload = :crypto.strong_rand_bytes(100)
+
+      for _i <- 1..10 do
+        :ok = Transmit.send_payload(stream, payload)
+
+        assert_receive {:srt_data, ^conn_id, ^payload}, 1_000
+      end
+
+      # the deltas of all the samples add up to the totals
+      Process.sleep(300)
+      :ok = Server.stop_stats_sampler(ctx.server)
+
+      samples = collect_stats_samples(conn_id)
+
+      assert Enum.sum(Enum.map(samples, & &1.pktRecv)) == 10
+      assert Enum.all?(samples, &(&1.msInterval > 0 and &1.mbpsRecvRate >= 0))
+
+      refute_receive {:srt_server_stats, _samples}, 300
     end
 
     @tag :srt_tools_required
@@ -223,7 +359,7 @@ defmodule ExLibSRT.ServerTest do
       stream = Transmit.start_stream(ctx.udp_port)
       on_exit(fn -> close_stream_safe(stream) end)
 
-      assert_receive {:srt_server_connect_request, address, _stream_id}, 2_000
+      assert_receive {:srt_server_connect_request, address, _stream_id, _request_id}, 2_000
       assert address == "127.0.0.1"
 
       assert {:ok, connection} =
@@ -252,6 +388,152 @@ defmodule ExLibSRT.ServerTest do
     end
   end
 
+  describe "server with batched receiving" do
+    setup do
+      udp_port = Enum.random(10_000..20_000)
+      srt_port = Enum.random(10_000..20_000)
+
+      {:ok, server} = Server.start("0.0.0.0", srt_port, "", -1, receive_batch: [max_packets: 4])
+      on_exit(fn -> Server.stop(server) end)
+
+      [udp_port: udp_port, srt_port: srt_port, server: server]
+    end
+
+    @tag :srt_tools_required
+    test "receive data in batches", ctx do
+      proxy =
+        Transmit.start_streaming_proxy(ctx.udp_port, ctx.srt_port, "batch_stream_id")
+
+      on_exit(fn -> stop_proxy_safe(proxy) end)
+
+      stream = Transmit.start_stream(ctx.udp_port)
+      on_exit(fn -> close_stream_safe(stream) end)
+
+      assert_receive {:srt_server_connect_request, _address, "batch_stream_id", _request_id}, 2_000
+
+      :ok = Server.accept_awaiting_connect_request(ctx.server)
+
+      assert_receive {:srt_server_conn, conn_id, _stream_id}, 1_000
+
+      expected = for i <- 1..10, do: "Hello world! (#{i})"
+
+      for payload <- expected do
+        :ok = Transmit.send_payload(stream, payload)
+      end
+
+      :ok = Transmit.close_stream(stream)
+
+      assert receive_batches(conn_id, length(expected)) == expected
+      refute_received {:srt_data, ^conn_id, _payload}
+
+      Transmit.stop_proxy(proxy)
+    end
+
+    test "rejects invalid batch options" do
+      assert {:error, "Invalid receive batch options", 0} =
+               Server.start_link("127.0.0.1", 8080, "", -1, receive_batch: [max_packets: 0])
+    end
+  end
+
+  describe "server sending data" do
+    setup :prepare_streaming
+
+    @tag :srt_tools_required
+    test "send data to many connections at once", ctx do
+      receivers =
+        for i <- 0..1 do
+          udp_port = ctx.udp_port + i
+
+          receiver = Transmit.start_stream_receiver(udp_port)
+          on_exit(fn -> close_stream_safe(receiver) end)
+
+          proxy = Transmit.start_pulling_proxy(ctx.srt_port, udp_port, "subscriber_#{i}")
+          on_exit(fn -> stop_proxy_safe(proxy) end)
+
+          assert_receive {:srt_server_connect_request, _address, "subscriber_" <> _id, request_id},
+                         2_000
+
+          :ok = Server.accept_awaiting_connect_request(request_id, ctx.server)
+
+          assert_receive {:srt_server_conn, ^request_id, _stream_id}, 1_000
+
+          {request_id, receiver}
+        end
+
+      conn_ids = Enum.map(receivers, &elem(&1, 0))
+
+      for i <- 1..10 do
+        assert {:ok, []} = Server.send_data("Hello subscribers! (#{i})", conn_ids, ctx.server)
+      end
+
+      for {_conn_id, receiver} <- receivers, i <- 1..10 do
+        assert {:ok, payload} = Transmit.receive_payload(receiver)
+        assert payload == "Hello subscribers! (#{i})"
+      end
+
+      assert {:ok, [-1]} = Server.send_data("Hello nobody!", -1, ctx.server)
+    end
+  end
+
+  describe "server with multiple workers" do
+    setup do
+      udp_port = Enum.random(10_000..20_000)
+      srt_port = Enum.random(10_000..20_000)
+
+      {:ok, server} = Server.start("0.0.0.0", srt_port, "", -1, workers: 4)
+      on_exit(fn -> Server.stop(server) end)
+
+      [udp_port: udp_port, srt_port: srt_port, server: server]
+    end
+
+    @tag :srt_tools_required
+    test "can handle multiple connections", ctx do
+      streams =
+        for udp_port <- ctx.udp_port..(ctx.udp_port + 7), into: %{} do
+          proxy = Transmit.start_streaming_proxy(udp_port, ctx.srt_port, "stream_#{udp_port}")
+          on_exit(fn -> stop_proxy_safe(proxy) end)
+
+          assert_receive {:srt_server_connect_request, _address, _stream_id, _request_id}, 2_000
+
+          :ok = Server.accept_awaiting_connect_request(ctx.server)
+
+          assert_receive {:srt_server_conn, conn_id, _stream_id}, 1_000
+
+          stream = Transmit.start_stream(udp_port)
+          on_exit(fn -> close_stream_safe(stream) end)
+
+          {conn_id, stream}
+        end
+
+      for {conn_id, stream} <- streams do
+        :ok = Transmit.send_payload(stream, "#{conn_id}")
+      end
+
+      for {conn_id, _stream} <- streams do
+        payload = "#{conn_id}"
+        assert_receive {:srt_data, ^conn_id, ^payload}, 500
+      end
+
+      for {conn_id, _stream} <- streams do
+        :ok = Server.close_server_connection(conn_id, ctx.server)
+        assert_receive {:srt_server_conn_closed, ^conn_id}, 1_000
+      end
+    end
+
+    test "rejects invalid number of workers" do
+      assert {:error, "Invalid :workers option", 0} =
+               Server.start_link("127.0.0.1", 8080, "", -1, workers: 0)
+    end
+
+    test "stops without waiting for the workers' epoll timeouts", ctx do
+      {:ok, server} = Server.start("127.0.0.1", ctx.srt_port + 1, "", -1, workers: 4)
+
+      {stop_time_us, :ok} = :timer.tc(fn -> Server.stop(server) end)
+
+      assert stop_time_us < 500_000
+    end
+  end
+
   # Password validation tests
   describe "server password validation" do
     test "rejects too short password" do
@@ -286,6 +568,28 @@ defmodule ExLibSRT.ServerTest do
     end
   end
 
+  defp receive_batches(conn_id, count, acc \\ [])
+
+  defp receive_batches(_conn_id, count, acc) when count <= 0, do: acc
+
+  defp receive_batches(conn_id, count, acc) do
+    assert_receive {:srt_data_batch, ^conn_id, packets}, 500
+    assert length(packets) in 1..4
+
+    receive_batches(conn_id, count - length(packets), acc ++ packets)
+  end
+
+  defp collect_stats_samples(conn_id, acc \\ []) do
+    receive do
+      {:srt_server_stats, samples} ->
+        assert [%ExLibSRT.StatsSample{conn: ^conn_id} = sample] = samples
+
+        collect_stats_samples(conn_id, [sample | acc])
+    after
+      0 -> Enum.reverse(acc)
+    end
+  end
+
   defp prepare_streaming(_ctx) do
     udp_port = Enum.random(10_000..20_000)
     srt_port = Enum.random(10_000..20_000)
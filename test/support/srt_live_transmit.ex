@@ -58,6 +58,23 @@ defmodule ExLibSRT.SRTLiveTransmit do
     port
   end
 
+  @spec start_pulling_proxy(non_neg_integer(), non_neg_integer(), binary()) :: receiving_proxy()
+  def start_pulling_proxy(srt_port, udp_port, stream_id \\ "") do
+    args = [
+      :binary,
+      {:args,
+       [
+         "-q",
+         "-loglevel:fatal",
+         "-autoreconnect:no",
+         "srt://127.0.0.1:#{srt_port}?streamid=#{stream_id}",
+         "udp://127.0.0.1:#{udp_port}"
+       ]}
+    ]
+
+    Port.open({:spawn_executable, find_executable("srt-live-transmit")}, args)
+  end
+
   defp find_executable(executable_name) do
     case System.find_executable(executable_name) do
       nil ->